@@ -27,6 +27,13 @@
 #include <limits>
 #include <iostream>
 
+int SNP::getWeight()
+{
+    int weight = 0;
+    for ( pair<Match*, int>& match : matches_ ) weight += match.first->getWeight();
+    return weight;
+}
+
 void SNPs::addSnp( vector<SNPs*>& snps, string seq, ConMap* cm, int baseCoord, int matchCoord, int len )
 {
     SNPs* cur = NULL;
@@ -93,9 +100,9 @@ string SNPs::resolve( string base )
 {
     string seq = base;
     int best = 0;
-    for ( SNP& snp : snps_ ) if ( snp.matches_.size() > best || ( snp.matches_.size() == best && snp.seq_ == base ) )
+    for ( SNP& snp : snps_ ) if ( snp.getWeight() > best || ( snp.getWeight() == best && snp.seq_ == base ) )
     {
-        best = snp.matches_.size();
+        best = snp.getWeight();
         seq = snp.seq_;
     }
     return seq;
@@ -107,8 +114,11 @@ int SNPs::score( unordered_set<Match*>& matches )
     {
         assert( matches.find( match.first ) == matches.end() );
     }
-    sort( snps_.begin(), snps_.end(), []( SNP& a, SNP& b ){ return a.matches_.size() > b.matches_.size(); } );
-    return score_ = ( snps_.empty() ? 0 : snps_[0].matches_.size() ) - matches.size();
+    // Each read counts once per copy collapsed into it at index time
+    int against = 0;
+    for ( Match* m : matches ) against += m->getWeight();
+    sort( snps_.begin(), snps_.end(), []( SNP& a, SNP& b ){ return a.getWeight() > b.getWeight(); } );
+    return score_ = ( snps_.empty() ? 0 : snps_[0].getWeight() ) - against;
 }
 
 void SNPs::setRemapped( vector<pair<int,int>>& remapped, unordered_map<SNPs*,int>& oldSnps, vector<SNPs*>& curSnp )
@@ -121,7 +131,7 @@ void SNPs::setRemapped( vector<pair<int,int>>& remapped, unordered_map<SNPs*,int
 }
 
 Bubble::BubbleMap::BubbleMap( Match* match, vector< pair<int,int> >& coords, int lanchor, int ranchor )
-: match_( match )
+: map_( NULL ), match_( match )
 {
     for ( pair<int, int> coord : coords ) addCoord( coord.first, coord.second );
     anchors_[0] = lanchor;
@@ -613,11 +623,6 @@ Bubble::Bubble( AlignResult& result, ConMap* l, ConMap* r )
     }
 }
 
-Bubble::~Bubble()
-{
-    for ( Bubble* b : bubs_ ) delete b;
-}
-
 void Bubble::abort()
 {
     for ( BubbleMap& bm : maps_ ) if ( !bm.coords_.empty() )
@@ -1075,7 +1080,9 @@ bool Bubble::retract( vector<ConMap*>& orphans )
 int Bubble::score( unordered_set<ConMap*>& maps )
 {
     for ( BubbleMap& bm : maps_ ) maps.erase( bm.map_ );
-    score_ = maps_.size()-maps.size();
+    score_ = 0;
+    for ( BubbleMap& bm : maps_ ) score_ += bm.match_->getWeight();
+    for ( ConMap* cm : maps ) score_ -= cm->node_->getWeight();
     for ( Bubble* b : bubs_ )
     {
         unordered_set<ConMap*> bmaps;
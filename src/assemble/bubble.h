@@ -30,11 +30,12 @@ struct Match;
 
 struct SNP
 {
+    int getWeight();
     vector< pair<Match*, int> > matches_;
     string seq_;
 };
 
-struct SNPs
+struct SNPs : ArenaObject<SNPs>
 {
     SNPs():score_( 0 ){};
     static void addSnp( vector<SNPs*>& snps, string seq, ConMap* cm, int baseCoord, int matchCoord, int len );
@@ -49,7 +50,7 @@ struct SNPs
     int start_, len_, score_;
 };
 
-struct Bubble
+struct Bubble : ArenaObject<Bubble>
 {
 //    struct IntraBubble
 //    {
@@ -64,7 +65,7 @@ struct Bubble
     };
     struct BubbleMap
     {
-        BubbleMap( ConMap* cm ): map_( cm ){};
+        BubbleMap( ConMap* cm ): map_( cm ), match_( cm->node_ ){};
         BubbleMap( Match* match, vector< pair<int,int> >& coords, int lanchor, int ranchor );
         void addCoord( int match, int bubble );
         void addCoord( int match, int bubble, int len );
@@ -109,7 +110,6 @@ struct Bubble
     Bubble( ConMap* cm, bool drxn );
     Bubble( AlignResult& result, ConMap* a, ConMap* b, bool drxn );
     Bubble( AlignResult& result, ConMap* l, ConMap* r );
-    ~Bubble();
     void abort();
     static void addBubble( vector<Bubble*>& bubbles, string seq, ConMap* cm, int baseCoord, int matchCoord, int len );
     void addBubble( pair<int,int> bubble, pair<int,int> read, ConMap* cm );
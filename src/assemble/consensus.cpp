@@ -22,6 +22,8 @@
 #include "target.h"
 #include "alignment.h"
 #include "consensus_resolution.h"
+#include "consensus_profile.h"
+#include "interval_index.h"
 #include <cassert>
 #include <algorithm>
 #include <iostream>
@@ -253,6 +255,7 @@ void Consensus::addMatch( Match* m )
 {
     ConMap* cm = new ConMap;
     cm->node_ = m;
+    m->map_ = cm;
     cm->coord_[0] = m->coords_[m->anchors_[0]];
     cm->coord_[1] = m->coords_[m->anchors_[1]];
     cm->range_[0] = cm->mapped_[0] = m->anchors_[0];
@@ -285,18 +288,15 @@ void Consensus::addMatch( ConMap* cm, Match* m, int blockStart, int blockLast, b
     {
         if ( blockStart < m->anchors_[0] ) m->anchors_[0] = blockStart;
         if ( blockLast > m->anchors_[1] ) m->anchors_[1] = blockLast;
-        for ( ConMap* cm : maps_ ) if ( cm->node_ == m )
-        {
-            cm->coord_[0] = min( cm->coord_[0], m->coords_[m->anchors_[0]] );
-            cm->coord_[1] = max( cm->coord_[1], m->coords_[m->anchors_[1]] );
-            cm->range_[0] = min( cm->range_[0], m->anchors_[0] );
-            cm->range_[1] = max( cm->range_[1], m->anchors_[1] );
-            cm->mapped_[0] = min( cm->mapped_[0], cm->range_[0] );
-            cm->mapped_[1] = max( cm->mapped_[1], cm->range_[1] );
-            coord_[0] = min( coord_[0], cm->coord_[0] );
-            coord_[1] = max( coord_[1], cm->coord_[1] );
-            break;
-        }
+        cm = getConMap( m );
+        cm->coord_[0] = min( cm->coord_[0], m->coords_[m->anchors_[0]] );
+        cm->coord_[1] = max( cm->coord_[1], m->coords_[m->anchors_[1]] );
+        cm->range_[0] = min( cm->range_[0], m->anchors_[0] );
+        cm->range_[1] = max( cm->range_[1], m->anchors_[1] );
+        cm->mapped_[0] = min( cm->mapped_[0], cm->range_[0] );
+        cm->mapped_[1] = max( cm->mapped_[1], cm->range_[1] );
+        coord_[0] = min( coord_[0], cm->coord_[0] );
+        coord_[1] = max( coord_[1], cm->coord_[1] );
     }
     int prv = blockLast, cur = blockLast;
     int minLen = 1;
@@ -384,70 +384,67 @@ bool Consensus::bridge( Consensus* lhs, Consensus* rhs )
     if ( !rhs->kmers_ ) rhs->mapKmers();
     
     ConsensusKmers* kmers[2] = { lhs->kmers_, rhs->kmers_ };
-    unordered_map<Match*, unordered_map<Match*,vector< pair<int, int> > > > hits;
+    vector<BridgeHit> hits;
     for ( int d : { 0, 1 } )
     {
-        Kmer* hit = NULL;
-        for ( const pair<uint16_t, Kmer>& k : kmers[!d]->ends_[d] ) if ( hit = kmers[d]->getKmer( k.first ) )
+        vector< pair<uint16_t, ConsensusKmers::Coord> >& ends = kmers[!d]->ends_[d];
+        for ( int i = 0, j = 0; i < ends.size(); i = j )
         {
-            for ( pair<Match*, int> a : k.second.coords_ ) for ( pair<Match*, int> b : hit->coords_ )
+            pair<ConsensusKmers::Coord*, ConsensusKmers::Coord*> hit = kmers[d]->getKmer( ends[i].first );
+            for ( j = i; j < ends.size() && ends[j].first == ends[i].first; j++ ) for ( ConsensusKmers::Coord* c = hit.first; c != hit.second; c++ )
             {
-                if ( d && b.second < b.first->anchors_[0] ) continue;
-                Match* matches[2]{ d ? a.first : b.first, d ? b.first : a.first };
-                pair<int,int> coords{ d ? a.second : b.second, d ? b.second : a.second };
-                auto ins1 = hits.insert( make_pair( matches[0], unordered_map<Match*, vector< pair<int, int> > >{} ) );
-                auto ins2 = ins1.first->second.insert( make_pair( matches[1], vector< pair<int, int> >{} ) );
-                ins2.first->second.push_back( coords );
+                if ( d && c->i_ < kmers[1]->matches_[ c->match_ ]->anchors_[0] ) continue;
+                ConsensusKmers::Coord coords[2]{ d ? ends[j].second : *c, d ? *c : ends[j].second };
+                Match* l = kmers[0]->matches_[ coords[0].match_ ],* r = kmers[1]->matches_[ coords[1].match_ ];
+                int lSpare = l->anchors_[1] < coords[0].i_ ? l->anchors_[1]+1-coords[0].i_ : max( 0, l->anchors_[1]-coords[0].i_-7 );
+                int rSpare = r->anchors_[0] < coords[1].i_ ? coords[1].i_-r->anchors_[0] : min( 0, coords[1].i_+8-r->anchors_[0] );
+                int overlap = max( 0, l->getAnchor( 1 ) - r->getAnchor( 0 ) );
+                if ( lSpare + rSpare - overlap < 10 ) hits.push_back( BridgeHit{ { coords[0].match_, coords[1].match_ }, { coords[0].i_, coords[1].i_ } } );
             }
         }
     }
     
-    typedef pair<pair<Match*, Match*>, vector< pair<int, int> > > MatchHits;
-    vector< MatchHits > hitLists;
-    for ( const pair<Match*, unordered_map<Match*,vector< pair<int, int> > > >& l : hits ) for ( const pair< Match*,vector< pair<int, int> > >& r : l.second )
-    {
-        vector< pair<int, int> > coords;
-        for ( pair<int, int> coord : r.second )
-        {
-            int lSpare = l.first->anchors_[1] < coord.first ? l.first->anchors_[1]+1-coord.first : max( 0, l.first->anchors_[1]-coord.first-7 );
-            int rSpare = r.first->anchors_[0] < coord.second ? coord.second-r.first->anchors_[0] : min( 0, coord.second+8-r.first->anchors_[0] );
-            int overlap = max( 0, l.first->getAnchor( 1 ) - r.first->getAnchor( 0 ) );
-            if ( lSpare + rSpare - overlap < 10 ) coords.push_back( coord );
-        }
-        if ( !coords.empty() )
-        {
-            sort( coords.begin(), coords.end(), []( pair<int, int>& a, pair<int, int>& b ){ return a.first == b.first ? a.second < b.second : a.first < b.first; } );
-            hitLists.push_back( make_pair( make_pair( l.first, r.first ), coords ) );
-        }
-    }
+    // Sort-merge: grouping by match pair then by lhs and rhs coords lays each diagonal out as a consecutive run
+    sort( hits.begin(), hits.end() );
+    hits.erase( unique( hits.begin(), hits.end() ), hits.end() );
     
-    sort( hitLists.begin(), hitLists.end(), []( MatchHits& a, MatchHits& b ){ return a.second.size() > b.second.size(); } );
-    for ( MatchHits& hit : hitLists )
+    vector<BridgeCandidate> candidates;
+    vector< pair< pair<int, int>, int> > blocks;
+    for ( int i = 0, j = 0; i < hits.size(); i = j )
     {
-        vector< pair< pair<int, int>, int> > blocks;
-        for ( int i = 0; i < hit.second.size(); i++ )
+        BridgeCandidate cand{ { hits[i].match_[0], hits[i].match_[1] }, 0, 0, { (int)blocks.size(), 0 } };
+        for ( j = i; j < hits.size() && hits[j].match_[0] == cand.match_[0] && hits[j].match_[1] == cand.match_[1]; j++ )
         {
-            pair<int, int> coords = hit.second[i];
+            pair<int, int> coords( hits[j].coord_[0], hits[j].coord_[1] );
             int len = 8;
-            for ( ; i+1 < hit.second.size(); i++ )
+            for ( ; j+1 < hits.size() && hits[j+1].match_[0] == cand.match_[0] && hits[j+1].match_[1] == cand.match_[1]; j++ )
             {
-                if ( hit.second[i].first+1 == hit.second[i+1].first && hit.second[i].second+1 == hit.second[i+1].second ) len++;
-                else if ( hit.second[i].first+9 == hit.second[i+1].first && hit.second[i].second+9 == hit.second[i+1].second ) len += 9;
+                if ( hits[j].coord_[0]+1 == hits[j+1].coord_[0] && hits[j].coord_[1]+1 == hits[j+1].coord_[1] ) len++;
+                else if ( hits[j].coord_[0]+9 == hits[j+1].coord_[0] && hits[j].coord_[1]+9 == hits[j+1].coord_[1] ) len += 9;
                 else break;
             }
             blocks.push_back( make_pair( coords, len ) );
+            cand.longest_ = max( cand.longest_, len );
         }
-        sort( blocks.begin(), blocks.end(), []( pair< pair<int, int>, int>& a, pair< pair<int, int>, int>& b ){ return a.second > b.second; } );
-        for ( int i = 0; i < blocks.size(); i++ )
+        cand.hits_ = j - i;
+        cand.blocks_[1] = blocks.size();
+        candidates.push_back( cand );
+    }
+    
+    int limit = min( (int)candidates.size(), int( maxBridgeCandidates_ ) );
+    partial_sort( candidates.begin(), candidates.begin() + limit, candidates.end() );
+    for ( int c = 0; c < limit; c++ )
+    {
+        pair<Match*, Match*> hit( kmers[0]->matches_[ candidates[c].match_[0] ], kmers[1]->matches_[ candidates[c].match_[1] ] );
+        vector< pair< pair<int, int>, int> >::iterator it = blocks.begin();
+        stable_sort( it + candidates[c].blocks_[0], it + candidates[c].blocks_[1], []( const pair< pair<int, int>, int>& a, const pair< pair<int, int>, int>& b ){ return a.second > b.second; } );
+        for ( int i = candidates[c].blocks_[0]; i < candidates[c].blocks_[1]; i++ )
         {
-            AlignResult result = Alignment::alignBySeed( hit.first.first->read_->seq_, hit.first.second->read_->seq_, blocks[i].first.first, blocks[i].first.second, blocks[i].second );
-            int unalignedCons[2]{ (int)hit.first.first->coords_.size() - hit.first.first->anchors_[1] - 1, hit.first.second->anchors_[0] };
-            int excessCons[2]{ lhs->coord_[1] - hit.first.first->getAnchor( 1 ), hit.first.second->getAnchor( 0 )-rhs->coord_[0] };
-            int overlap = max( 0, hit.first.first->getAnchor( 1 ) + unalignedCons[0] - hit.first.second->getAnchor( 0 ) + unalignedCons[1] );
-            int sparePenalty = max( 0, result.rIgnore[0] - unalignedCons[0] ) + max( 0, result.lIgnore[1] - unalignedCons[1] );
-            if ( Match::isBridge( hit.first.first, hit.first.second, result, excessCons[0]+excessCons[1] ) )
+            AlignResult result = Alignment::alignBySeed( hit.first->read_->seq_, hit.second->read_->seq_, blocks[i].first.first, blocks[i].first.second, blocks[i].second );
+            int excessCons[2]{ lhs->coord_[1] - hit.first->getAnchor( 1 ), hit.second->getAnchor( 0 )-rhs->coord_[0] };
+            if ( Match::isBridge( hit.first, hit.second, result, excessCons[0]+excessCons[1] ) )
             {
-                return lhs->merge( rhs, result, hit.first.first, hit.first.second );
+                return lhs->merge( rhs, result, hit.first, hit.second );
             }
         }
     }
@@ -493,7 +490,7 @@ void Consensus::foldEnds()
     for ( ConMap* cm : maps_ ) assert( cm->range_[1] < cm->node_->size() );
     for ( ConMap* cm : maps_ ) assert( cm->mapped_[1] < cm->node_->size() );
     sort( maps_.begin(), maps_.end(), []( ConMap* a, ConMap* b ){ return a->coord_[0] == b->coord_[0] ? a->coord_[1] > b->coord_[1] : a->coord_[0] < b->coord_[0]; } );
-    sort( snps_.begin(), snps_.end(), []( SNPs* a, SNPs* b ){ return a->start_ == b->start_ ? a->start_+a->len_ > b->start_+b->len_ : a->start_ < b->start_; } );
+    IntervalIndex<SNPs>::order( snps_ );
     
     vector<ConMap*> ends[2];
     for ( ConMap* cm : maps_ ) for ( int d : { 0, 1 } ) if ( cm->unmapped( d ) ) ends[d].push_back( cm );
@@ -537,25 +534,21 @@ void Consensus::foldEnds()
 
 ConMap* Consensus::getConMap( Match* m )
 {
-    for ( ConMap* cm : maps_ ) if ( cm->node_ == m ) return cm;
-    assert( false );
-    return NULL;
+    // Each match is mapped once, by whichever consensus now holds its cluster
+    assert( m->map_ && m->map_->node_ == m );
+    return m->map_;
 }
 
 void Consensus::mapKmers()
 {
     if ( kmers_ ) delete kmers_;
-    kmers_ = new ConsensusKmers();
-    
-    for ( ConMap* cm : maps_ )
-    {
-        kmers_->addMatch( cm->node_, cm->range_ );
-    }
+    kmers_ = new ConsensusKmers( maps_ );
 }
 
 bool Consensus::merge( Consensus* rhs )
 {
     assert( tar_ && tar_ == rhs->tar_ );
+    for ( ConMap* cm : rhs->maps_ ) assert( cm->node_->map_ == cm );
     coord_[1] = max( coord_[1], rhs->coord_[1] );
     maps_.insert( maps_.end(), rhs->maps_.begin(), rhs->maps_.end() );
     snps_.insert( snps_.end(), rhs->snps_.begin(), rhs->snps_.end() );
@@ -567,8 +560,8 @@ bool Consensus::merge( Consensus* rhs )
     rhs->snps_.clear();
     rhs->bubble_.clear();
     for ( int d : { 0, 1 } ) rhs->branch_[d].clear(); 
-    sort( bubble_.begin(), bubble_.end(), []( Bubble* a, Bubble* b ){ return a->start_ < b->start_; } );
-    sort( snps_.begin(), snps_.end(), []( SNPs* a, SNPs* b ){ return a->start_ < b->start_; } );
+    IntervalIndex<Bubble>::order( bubble_ );
+    IntervalIndex<SNPs>::order( snps_ );
     return true;
 }
 
@@ -598,8 +591,8 @@ bool Consensus::merge( Consensus* rhs, AlignResult& result, Match* l, Match* r )
     bubble_.push_back( bridge );
     for ( int d : { 0, 1 } ) for ( ConMap* cm : maps[d] ) foldEnd( cm, NULL, true, false, !d );
     
-    sort( bubble_.begin(), bubble_.end(), []( Bubble* a, Bubble* b ){ return a->start_ < b->start_; } );
-    sort( snps_.begin(), snps_.end(), []( SNPs* a, SNPs* b ){ return a->start_ < b->start_; } );
+    IntervalIndex<Bubble>::order( bubble_ );
+    IntervalIndex<SNPs>::order( snps_ );
     assert( !bridge->maps_.empty() );
     Bubble::test( bubble_ );
 //    addBubble( l, r, result );
@@ -609,19 +602,15 @@ bool Consensus::merge( Consensus* rhs, AlignResult& result, Match* l, Match* r )
 
 void Consensus::resolveBubbles()
 {
-    int iS = 0, iB = 0;
-    sort( bubble_.begin(), bubble_.end(), []( Bubble* a, Bubble* b ){ return a->start_ == b->start_ ? a->start_+a->len_ > b->start_+b->len_ : a->start_ < b->start_; } );
-    sort( snps_.begin(), snps_.end(), []( SNPs* a, SNPs* b ){ return a->start_ == b->start_ ? a->start_+a->len_ > b->start_+b->len_ : a->start_ < b->start_; } );
+    IntervalIndex<Bubble> bubIndex( bubble_ );
+    IntervalIndex<SNPs> snpIndex( snps_ );
     vector<ConMap*> orphans;
     for ( int i = 0; i < bubble_.size(); i++ )
     {
         Bubble* b = bubble_[i];
-        vector<SNPs*> snps;
-        vector<Bubble*> bubs;
-        while ( iS < snps_.size() && snps_[iS]->start_ + snps_[iS]->len_ <= b->start_ ) iS++;
-        while ( iB < bubble_.size() && bubble_[iB]->start_ + bubble_[iB]->len_ <= b->start_ ) iB++;
-        for ( int j = iS; j < snps_.size() && ( snps_[j]->start_ < b->start_ + b->len_ ); j++ ) snps.push_back( snps_[j] );
-        for ( int j = iB; j < bubble_.size() && ( bubble_[j]->start_ < b->start_ + b->len_ ); j++ ) if ( bubble_[j] != b ) bubs.push_back( bubble_[j] );
+        vector<SNPs*> snps = snpIndex.overlaps( b->start_, b->start_ + b->len_ );
+        vector<Bubble*> bubs = bubIndex.overlaps( b->start_, b->start_ + b->len_ );
+        bubs.erase( remove( bubs.begin(), bubs.end(), b ), bubs.end() );
         if ( snps.empty() && bubs.empty() && b->bubs_.empty() ) continue;
         if ( !b->consolidate( snps, bubs, bubble_, tar_->seq_ ) ) continue;
         if ( b->retract( orphans ) )
@@ -629,7 +618,7 @@ void Consensus::resolveBubbles()
             delete b;
             bubble_.erase( bubble_.begin() + i );
         }
-        sort( bubble_.begin(), bubble_.end(), []( Bubble* a, Bubble* b ){ return a->start_ == b->start_ ? a->start_+a->len_ > b->start_+b->len_ : a->start_ < b->start_; } );
+        bubIndex.update();
         i--;
     }
     Bubble::test( bubble_ );
@@ -687,6 +676,9 @@ void Consensus::resolveBranches()
 
 string Consensus::resolve()
 {
+    ConsensusProfile profile( maps_, template_, coord_[0], coord_[1] );
+    if ( profile.simple_ ) return consensus_ = profile.getConsensus();
+    
     Bubble::test( bubble_ );
     foldEnds();
     Bubble::test( bubble_ );
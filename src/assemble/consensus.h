@@ -29,13 +29,35 @@
 
 class Target;
 
-class Consensus
+class Consensus : public ArenaObject<Consensus>
 {
     struct Branch
     {
         string template_, consensus_;
         int coord_, drxn_;
     };
+    struct BridgeHit
+    {
+        uint32_t match_[2];
+        int coord_[2];
+        bool operator<( const BridgeHit& rhs ) const
+        {
+            for ( int d : { 0, 1 } ) if ( match_[d] != rhs.match_[d] ) return match_[d] < rhs.match_[d];
+            return coord_[0] != rhs.coord_[0] ? coord_[0] < rhs.coord_[0] : coord_[1] < rhs.coord_[1];
+        }
+        bool operator==( const BridgeHit& rhs ) const { return !( *this < rhs ) && !( rhs < *this ); }
+    };
+    struct BridgeCandidate
+    {
+        uint32_t match_[2];
+        int hits_, longest_, blocks_[2];
+        bool operator<( const BridgeCandidate& rhs ) const
+        {
+            if ( hits_ != rhs.hits_ ) return hits_ > rhs.hits_;
+            if ( longest_ != rhs.longest_ ) return longest_ > rhs.longest_;
+            return match_[0] != rhs.match_[0] ? match_[0] < rhs.match_[0] : match_[1] < rhs.match_[1];
+        }
+    };
     void addBranch( ConMap* cm, vector<pair<ConMap*, AlignResult>>& hits, bool drxn );
     bool addBubble( Match* l, Match* r, AlignResult& result );
     void addMatch( Match* match );
@@ -53,6 +75,7 @@ class Consensus
     void setBranches();
     void setBubbles();
     void updateMapped( ConMap* cm, SnpAlignResult& result, int base, bool drxn );
+    static const int maxBridgeCandidates_ = 32;
     Target* tar_;
     ConsensusKmers* kmers_;
     int coord_[2];
@@ -20,32 +20,43 @@
 
 #include "consensus_kmers.h"
 #include "read.h"
-#include "shared_functions.h"
+#include "constants.h"
+#include <algorithm>
 
-void ConsensusKmers::addMatch( Match* match, int range[2] )
+ConsensusKmers::ConsensusKmers( vector<ConMap*>& maps )
+: offsets_( ( 1 << 16 ) + 1, 0 )
 {
-    auto addKmer = [&]( unordered_map<uint16_t, Kmer>& kmers, uint16_t k, int i ){
-        auto it = kmers.find( k );
-        if ( it != kmers.end() ) it->second.coords_.push_back( make_pair( match, i ) );
-        else kmers.insert( make_pair( k, Kmer( match, i ) ) );
+    auto roll = [&]( bool fill ){
+        for ( uint32_t m = 0; m < maps.size(); m++ )
+        {
+            const string& seq = maps[m]->node_->read_->seq_;
+            uint16_t k = 0;
+            for ( int i = 0; i < seq.size(); i++ )
+            {
+                k = ( k << 2 ) + charToInt[ (uint8_t)seq[i] ];
+                if ( i < 7 ) continue;
+                if ( !fill ) offsets_[k+1]++;
+                if ( !fill ) continue;
+                Coord c{ m, i-7 };
+                coords_[ offsets_[k]++ ] = c;
+                if ( i-7 < maps[m]->range_[0] ) ends_[0].push_back( make_pair( k, c ) );
+                if ( maps[m]->range_[1] < i+1 ) ends_[1].push_back( make_pair( k, c ) );
+            }
+        }
     };
-    vector<uint16_t> kmers = get8mers( match->read_->seq_, 0, match->read_->seq_.size() );
-    for ( int i = 0; i < kmers.size(); i++ )
-    {
-        addKmer( kmers_, kmers[i], i );
-        if ( i < range[0] ) addKmer( ends_[0], kmers[i], i );
-        if ( range[1] < i+8 ) addKmer( ends_[1], kmers[i], i );
-    }
+    
+    // Count each 8-mer, convert the counts to offsets, then fill; filling advances each offset to the next 8-mer's start
+    for ( ConMap* cm : maps ) matches_.push_back( cm->node_ );
+    roll( false );
+    for ( int k = 0; k < 1 << 16; k++ ) offsets_[k+1] += offsets_[k];
+    coords_.resize( offsets_.back() );
+    roll( true );
+    for ( int k = 1 << 16; k > 0; k-- ) offsets_[k] = offsets_[k-1];
+    offsets_[0] = 0;
+    for ( int d : { 0, 1 } ) stable_sort( ends_[d].begin(), ends_[d].end(), []( const pair<uint16_t, Coord>& a, const pair<uint16_t, Coord>& b ){ return a.first < b.first; } );
 }
 
-Kmer* ConsensusKmers::getEndKmer( uint16_t k, bool drxn )
+pair<ConsensusKmers::Coord*, ConsensusKmers::Coord*> ConsensusKmers::getKmer( uint16_t k )
 {
-    auto it = ends_[drxn].find( k );
-    return it != ends_[drxn].end() ? &it->second : NULL;
-}
-
-Kmer* ConsensusKmers::getKmer( uint16_t k )
-{
-    auto it = kmers_.find( k );
-    return it != kmers_.end() ? &it->second : NULL;
+    return make_pair( coords_.data() + offsets_[k], coords_.data() + offsets_[k+1] );
 }
@@ -22,19 +22,22 @@
 #define CONSENSUS_KMERS_H
 
 #include "match.h"
+#include "consensus_map.h"
 
-struct Kmer
-{
-    Kmer( Match* match ,int i ): coords_{ make_pair( match, i ) } {};
-    vector<pair<Match*,int>> coords_;
-};
-
+// Every 8-mer of a cluster's reads in one contiguous array, grouped by 8-mer through a direct-indexed offset table
 struct ConsensusKmers
 {
-    void addMatch( Match* match, int range[2] );
-    Kmer* getEndKmer( uint16_t k, bool drxn );
-    Kmer* getKmer( uint16_t k );
-    unordered_map<uint16_t, Kmer> kmers_, ends_[2];
+    struct Coord
+    {
+        uint32_t match_;
+        int32_t i_;
+    };
+    ConsensusKmers( vector<ConMap*>& maps );
+    pair<Coord*, Coord*> getKmer( uint16_t k );
+    vector<Match*> matches_;
+    vector<uint32_t> offsets_;
+    vector<Coord> coords_;
+    vector< pair<uint16_t, Coord> > ends_[2];
 };
 
 #endif /* CONSENSUS_KMERS_H */
@@ -23,10 +23,11 @@
 
 #include "types.h"
 #include "align_result.h"
+#include "arena.h"
 
 struct Match;
 
-struct ConMap
+struct ConMap : ArenaObject<ConMap>
 {
     bool isConsensus( vector< pair<int,int> >& noncoords, int start, int end );
     static vector<ConMap*> getFoldableEnds( vector<ConMap*>& maps, vector<pair<int,int>>& remapped, bool d );
@@ -0,0 +1,144 @@
+/*
+ * Copyright (C) 2017 Glen T. Wilkins <glen.t.wilkins@gmail.com>
+ * Written by Glen T. Wilkins
+ * 
+ * This file is part of the consensible software package <https://github.com/gtwilkins/Consensible>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "consensus_profile.h"
+#include "match.h"
+#include "read.h"
+#include "constants.h"
+#include <algorithm>
+
+ConsensusProfile::ConsensusProfile( vector<ConMap*>& maps, string& tar, int start, int end )
+: simple_( true ), tar_( tar ), start_( start ), kind_( end+1-start, 0 )
+{
+    for ( int i = 0; i < 5; i++ ) base_[i].assign( kind_.size(), 0 );
+    for ( int i = 0; i < 4; i++ ) ins_[i].assign( kind_.size(), 0 );
+    for ( int d : { 0, 1 } ) ref_[d].assign( kind_.size(), 0 );
+    depth_.assign( kind_.size()+1, 0 );
+    tail_.assign( kind_.size()+1, 0 );
+    for ( int i = 0; i < maps.size() && simple_; i++ ) addRead( maps[i] );
+    for ( int i = 0, depth = 0, tail = 0; i < kind_.size(); i++ )
+    {
+        depth_[i] = depth += depth_[i];
+        tail_[i] = tail += tail_[i];
+        if ( tail ) kind_[i] |= 4;
+    }
+    for ( int i = 0; i < kind_.size() && simple_; i++ ) if ( kind_[i] ) simple_ = settle( i );
+}
+
+void ConsensusProfile::addRead( ConMap* cm )
+{
+    vector<int>& coords = cm->node_->coords_;
+    string& seq = cm->node_->read_->seq_;
+    int first = cm->range_[0], last = cm->range_[1], w = cm->node_->getWeight();
+    if ( coords[first] < start_ || start_+(int)kind_.size() <= coords[last] ) simple_ = false;
+    if ( !simple_ ) return;
+    depth_[ coords[first]-start_ ] += w;
+    depth_[ coords[last]+1-start_ ] -= w;
+    
+    // Unmapped ends may yet be folded or branched anywhere near where they leave the template
+    for ( int d : { 0, 1 } ) if ( int len = max( cm->uncoorded( d ), cm->unmapped( d ) ) )
+    {
+        int limits[2]{ d ? coords[last] : coords[first]-len-10, d ? coords[last]+len+10 : coords[first] };
+        if ( limits[0] < start_ || start_+(int)kind_.size() <= limits[1] ) simple_ = false;
+        if ( !simple_ ) return;
+        tail_[ limits[0]-start_ ] += w;
+        tail_[ limits[1]+1-start_ ] -= w;
+    }
+    
+    for ( int i = first; i <= last; i++ )
+    {
+        int c = coords[i], b = charToInt[ seq[i] ];
+        if ( i < last && coords[i+1] == c )
+        {
+            bool lone = b < 4 && first < i && coords[i-1]+1 == c && ( i+2 > last || coords[i+2] != c );
+            if ( lone ) ins_[b][c-start_] += w;
+            kind_[c-start_] |= lone ? 2 : 8;
+            continue;
+        }
+        
+        int prv = i;
+        while ( first < prv && coords[prv-1] == c ) prv--;
+        if ( first < prv && coords[prv-1]+1 < c )
+        {
+            bool lone = prv == i && coords[i-1]+2 == c;
+            if ( lone ) base_[4][c-1-start_] += w;
+            for ( int j = coords[prv-1]+1; j < c; j++ ) kind_[j-start_] |= lone ? 1 : 8;
+        }
+        
+        if ( b != charToInt[ tar_[c] ] || b > 3 )
+        {
+            bool lone = b < 4 && first < i && i < last;
+            if ( lone ) base_[b][c-start_] += w;
+            kind_[c-start_] |= lone ? 1 : 8;
+            continue;
+        }
+        if ( first < i && coords[i-1] == c-1 ) ref_[0][c-start_] += w;
+        if ( i < last && coords[i+1] == c+1 ) ref_[1][c-start_] += w;
+    }
+}
+
+bool ConsensusProfile::settle( int i )
+{
+    // Anything other than a lone substitution, deletion or insertion is left to the template only if it can't be outvoted
+    if ( kind_[i] & 8 || kind_[i] == 4 )
+    {
+        uint32_t support = kind_[i] & 8 ? min( ref_[0][i], ref_[1][i] ) : max( ref_[0][i], ref_[1][i] );
+        kind_[i] = 0;
+        return depth_[i] + tail_[i] - support < support;
+    }
+    
+    for ( int k : { 2, 1 } ) if ( kind_[i] & k )
+    {
+        // Reads spanning the column that are neither template nor a called allele here could still be folded either way
+        vector<uint32_t>* alleles = k == 1 ? base_ : ins_;
+        uint32_t support = ref_[ k == 1 ][i], best = 0, second = 0, unknown = depth_[i] + tail_[i] - support;
+        for ( int b = 0; b < ( k == 1 ? 5 : 4 ); b++ )
+        {
+            unknown -= alleles[b][i];
+            if ( alleles[b][i] > best ) second = best;
+            if ( alleles[b][i] > best ) best = alleles[b][i];
+            else second = max( second, alleles[b][i] );
+        }
+        if ( best + unknown <= support ) kind_[i] &= ~k;
+        else if ( best <= support + unknown || best <= second + unknown ) return false;
+    }
+    kind_[i] &= 3;
+    return true;
+}
+
+string ConsensusProfile::getConsensus()
+{
+    string seq;
+    seq.reserve( kind_.size() );
+    for ( int i = 0; i < kind_.size(); i++ )
+    {
+        int best = -1;
+        uint32_t support = ref_[0][i];
+        if ( kind_[i] & 2 ) for ( int b = 0; b < 4; b++ ) if ( ins_[b][i] > support ) support = ins_[ best = b ][i];
+        if ( best >= 0 ) seq += intToChar[best];
+        
+        best = -1;
+        support = ref_[1][i];
+        if ( kind_[i] & 1 ) for ( int b = 0; b < 5; b++ ) if ( base_[b][i] > support ) support = base_[ best = b ][i];
+        if ( best < 0 ) seq += tar_[start_+i];
+        else if ( best < 4 ) seq += intToChar[best];
+    }
+    return seq;
+}
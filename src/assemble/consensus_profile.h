@@ -0,0 +1,43 @@
+/*
+ * Copyright (C) 2017 Glen T. Wilkins <glen.t.wilkins@gmail.com>
+ * Written by Glen T. Wilkins
+ * 
+ * This file is part of the consensible software package <https://github.com/gtwilkins/Consensible>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CONSENSUS_PROFILE_H
+#define CONSENSUS_PROFILE_H
+
+#include "types.h"
+#include "consensus_map.h"
+
+// Per-column read counts over a cluster's template span, one array per symbol indexed by template coord. A column is
+// only called from the counts if no read that is unaccounted for there could tip the call, otherwise simple_ is unset.
+struct ConsensusProfile
+{
+    ConsensusProfile( vector<ConMap*>& maps, string& tar, int start, int end );
+    string getConsensus();
+    bool simple_;
+private:
+    void addRead( ConMap* cm );
+    bool settle( int i );
+    string& tar_;
+    int start_;
+    vector<uint32_t> base_[5]/*A,C,G,T,gap*/, ins_[4], ref_[2]/*template base contiguous to the left, right*/, depth_, tail_;
+    vector<uint8_t> kind_;
+};
+
+#endif /* CONSENSUS_PROFILE_H */
@@ -0,0 +1,96 @@
+/*
+ * Copyright (C) 2017 Glen T. Wilkins <glen.t.wilkins@gmail.com>
+ * Written by Glen T. Wilkins
+ * 
+ * This file is part of the consensible software package <https://github.com/gtwilkins/Consensible>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef INTERVAL_INDEX_H
+#define INTERVAL_INDEX_H
+
+#include "types.h"
+#include <algorithm>
+
+// Overlap index over a vector of Bubble or SNPs pointers, kept sorted by start_ (longest first) with the maximum end of each
+// subtree stored in place as an implicit binary tree; appended or edited entries only need the unsorted tail re-sorted
+template<typename T>
+class IntervalIndex
+{
+    static int end( T* t ){ return t->start_ + t->len_; };
+    static bool before( T* a, T* b ){ return a->start_ == b->start_ ? end( a ) > end( b ) : a->start_ < b->start_; };
+    vector<T*>& items_;
+    vector<int> maxEnd_;
+    int levels_;
+public:
+    IntervalIndex( vector<T*>& items ): items_( items ){ update(); };
+    
+    static void order( vector<T*>& items )
+    {
+        auto it = is_sorted_until( items.begin(), items.end(), before );
+        if ( it == items.end() ) return;
+        sort( it, items.end(), before );
+        inplace_merge( items.begin(), it, items.end(), before );
+    }
+    
+    void update()
+    {
+        order( items_ );
+        int n = items_.size(), last = 0, lastI = 0, k = 1;
+        maxEnd_.resize( n );
+        for ( int i = 0; i < n; i += 2 ) last = maxEnd_[ lastI = i ] = end( items_[i] );
+        for ( ; ( 1 << k ) <= n; k++ )
+        {
+            int x = 1 << ( k-1 );
+            for ( int i = ( x << 1 ) - 1; i < n; i += x << 2 ) maxEnd_[i] = max( end( items_[i] ), max( maxEnd_[i-x], i+x < n ? maxEnd_[i+x] : last ) );
+            lastI = ( lastI >> k ) & 1 ? lastI - x : lastI + x;
+            if ( lastI < n ) last = max( last, maxEnd_[lastI] );
+        }
+        levels_ = k-1;
+    }
+    
+    // Every entry overlapping [start, end), in index order
+    vector<T*> overlaps( int start, int stop )
+    {
+        vector<T*> hits;
+        int n = items_.size();
+        vector< pair<int, int> > stack{ make_pair( ( 1 << levels_ ) - 1, levels_ << 1 ) };
+        while ( !stack.empty() )
+        {
+            int x = stack.back().first, k = stack.back().second >> 1, right = stack.back().second & 1;
+            stack.pop_back();
+            if ( k <= 3 )
+            {
+                int i = x >> k << k, last = min( n, i + ( 1 << ( k+1 ) ) - 1 );
+                for ( ; i < last && items_[i]->start_ < stop; i++ ) if ( start < end( items_[i] ) ) hits.push_back( items_[i] );
+            }
+            else if ( !right )
+            {
+                int y = x - ( 1 << ( k-1 ) );
+                stack.push_back( make_pair( x, ( k << 1 ) | 1 ) );
+                if ( y >= n || maxEnd_[y] > start ) stack.push_back( make_pair( y, ( k-1 ) << 1 ) );
+            }
+            else if ( x < n && items_[x]->start_ < stop )
+            {
+                if ( start < end( items_[x] ) ) hits.push_back( items_[x] );
+                stack.push_back( make_pair( x + ( 1 << ( k-1 ) ), ( k-1 ) << 1 ) );
+            }
+        }
+        return hits;
+    }
+};
+
+#endif /* INTERVAL_INDEX_H */
+
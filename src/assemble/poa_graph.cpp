@@ -0,0 +1,211 @@
+/*
+ * Copyright (C) 2017 Glen T. Wilkins <glen.t.wilkins@gmail.com>
+ * Written by Glen T. Wilkins
+ * 
+ * This file is part of the consensible software package <https://github.com/gtwilkins/Consensible>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "poa_graph.h"
+#include "read.h"
+#include "constants.h"
+#include <algorithm>
+#include <cassert>
+
+// Rows are scored a vector of read positions at a time for the diagonal and vertical moves from every predecessor,
+// then the horizontal move is carried along the row in a scalar pass.
+
+#if defined( __AVX2__ )
+#include <immintrin.h>
+typedef __m256i Vec;
+static const int lanes = 16;
+static inline Vec vSet( int x ){ return _mm256_set1_epi16( x ); }
+static inline Vec vLoad( int16_t* p ){ return _mm256_loadu_si256( (Vec*)p ); }
+static inline void vStore( int16_t* p, Vec a ){ _mm256_storeu_si256( (Vec*)p, a ); }
+static inline Vec vAdd( Vec a, Vec b ){ return _mm256_adds_epi16( a, b ); }
+static inline Vec vMax( Vec a, Vec b ){ return _mm256_max_epi16( a, b ); }
+#elif defined( __SSE2__ )
+#include <emmintrin.h>
+typedef __m128i Vec;
+static const int lanes = 8;
+static inline Vec vSet( int x ){ return _mm_set1_epi16( x ); }
+static inline Vec vLoad( int16_t* p ){ return _mm_loadu_si128( (Vec*)p ); }
+static inline void vStore( int16_t* p, Vec a ){ _mm_storeu_si128( (Vec*)p, a ); }
+static inline Vec vAdd( Vec a, Vec b ){ return _mm_adds_epi16( a, b ); }
+static inline Vec vMax( Vec a, Vec b ){ return _mm_max_epi16( a, b ); }
+#else
+static const int lanes = 1;
+#endif
+
+static const int16_t hit = 2, miss = -4, gap = -4, off = -1000;
+
+PoaGraph::PoaGraph( string& seq, int start, int end )
+: sorted_( false )
+{
+    for ( int i = start; i <= end; i++ ) addNode( seq[i], i );
+    for ( int i = 1; i < nodes_.size(); i++ ) addEdge( i-1, i, 0 );
+    sort();
+}
+
+void PoaGraph::addEdge( int l, int r, int weight )
+{
+    for ( pair<int, int>& e : nodes_[r].in_ ) if ( e.first == l )
+    {
+        e.second += weight;
+        return;
+    }
+    nodes_[r].in_.push_back( make_pair( l, weight ) );
+    nodes_[l].out_.push_back( r );
+    if ( pos_.size() <= max( l, r ) || pos_[r] < pos_[l] ) sorted_ = false;
+}
+
+void PoaGraph::addMatch( Match* m )
+{
+    string& seq = m->read_->seq_;
+    int prv = -1;
+    for ( pair<int, int>& p : align( seq, m->coords_ ) ) if ( p.second >= 0 )
+    {
+        int node = p.first;
+        if ( node < 0 ) node = addNode( seq[p.second], nodes_[prv].coord_ );
+        else if ( nodes_[node].base_ != seq[p.second] )
+        {
+            int base = node;
+            node = -1;
+            for ( int a : nodes_[base].aligned_ ) if ( nodes_[a].base_ == seq[p.second] ) node = a;
+            if ( node < 0 )
+            {
+                node = addNode( seq[p.second], nodes_[base].coord_ );
+                for ( int a : nodes_[base].aligned_ ) nodes_[a].aligned_.push_back( node );
+                for ( int a : nodes_[base].aligned_ ) nodes_[node].aligned_.push_back( a );
+                nodes_[base].aligned_.push_back( node );
+                nodes_[node].aligned_.push_back( base );
+            }
+        }
+        if ( prv >= 0 ) addEdge( prv, node, m->getWeight() );
+        prv = node;
+    }
+    if ( !sorted_ ) sort();
+}
+
+int PoaGraph::addNode( char base, int coord )
+{
+    nodes_.push_back( Node( base, coord ) );
+    return nodes_.size()-1;
+}
+
+vector< pair<int, int> > PoaGraph::align( string& seq, vector<int>& coords )
+{
+    int n = seq.size(), w = ( 2*band_ + lanes ) / lanes * lanes, stride = 3*w;
+    vector<int> sub, los;
+    for ( int i = 0; i < order_.size(); i++ ) if ( coords[0]-band_ <= orderCoords_[i] && orderCoords_[i] <= coords[n-1]+band_ ) sub.push_back( order_[i] );
+    for ( int v : sub ) los.push_back( int( lower_bound( coords.begin(), coords.end(), nodes_[v].coord_ ) - coords.begin() ) - band_ );
+    
+    // One score row per base, padded so that positions off either end of the read can never seed an alignment
+    profile_.assign( 5*( n+3*w ), off );
+    for ( int b = 0; b < 5; b++ ) for ( int j = 0; j < n; j++ ) profile_[ b*( n+3*w ) + w + j ] = b < 4 && charToInt[ seq[j] ] == b ? hit : miss;
+    rows_.assign( sub.size()*stride, 0 );
+    rank_.resize( nodes_.size(), -1 );
+    for ( int r = 0; r < sub.size(); r++ ) rank_[ sub[r] ] = r;
+    
+    int best = 0, bestR = -1, bestJ = -1;
+    for ( int r = 0; r < sub.size(); r++ )
+    {
+        int16_t* h = &rows_[ r*stride + w ],* p = &profile_[ min( 4, (int)charToInt[ nodes_[ sub[r] ].base_ ] )*( n+3*w ) + w + los[r] ];
+#if defined( __AVX2__ ) || defined( __SSE2__ )
+        for ( int k = 0; k < w; k += lanes ) vStore( h+k, vMax( vLoad( p+k ), vSet( 0 ) ) );
+#else
+        for ( int k = 0; k < w; k++ ) h[k] = max( (int16_t)0, p[k] );
+#endif
+        for ( pair<int, int>& e : nodes_[ sub[r] ].in_ ) if ( rank_[e.first] >= 0 && abs( los[r] - los[ rank_[e.first] ] ) < w )
+        {
+            int16_t* hp = &rows_[ rank_[e.first]*stride + w + los[r] - los[ rank_[e.first] ] ];
+#if defined( __AVX2__ ) || defined( __SSE2__ )
+            for ( int k = 0; k < w; k += lanes ) vStore( h+k, vMax( vLoad( h+k ), vMax( vAdd( vLoad( hp+k-1 ), vLoad( p+k ) ), vAdd( vLoad( hp+k ), vSet( gap ) ) ) ) );
+#else
+            for ( int k = 0; k < w; k++ ) h[k] = max( h[k], (int16_t)max( hp[k-1] + p[k], hp[k] + gap ) );
+#endif
+        }
+        for ( int k = max( 0, -los[r] ); k < w && los[r]+k < n; k++ )
+        {
+            if ( k ) h[k] = max( h[k], (int16_t)( h[k-1] + gap ) );
+            if ( h[k] <= best ) continue;
+            best = h[k];
+            bestR = r;
+            bestJ = los[r]+k;
+        }
+    }
+    
+    auto score = [&]( int r, int j ){ int k = j - los[r]; return r >= 0 && 0 <= j && 0 <= k && k < w ? rows_[ r*stride + w + k ] : 0; };
+    vector< pair<int, int> > path;
+    for ( int r = bestR, j = bestJ, h = best; h > 0; h = score( r, j ) )
+    {
+        Node& node = nodes_[ sub[r] ];
+        int s = charToInt[ seq[j] ] == charToInt[ node.base_ ] && charToInt[ node.base_ ] < 4 ? hit : miss, prv = -1;
+        path.push_back( make_pair( sub[r], j ) );
+        if ( h == s ) break;
+        for ( pair<int, int>& e : node.in_ ) if ( prv < 0 && rank_[e.first] >= 0 && score( rank_[e.first], j-1 ) + s == h ) prv = rank_[e.first];
+        if ( prv >= 0 )
+        {
+            r = prv;
+            j--;
+            continue;
+        }
+        for ( pair<int, int>& e : node.in_ ) if ( prv < 0 && rank_[e.first] >= 0 && score( rank_[e.first], j ) + gap == h ) prv = rank_[e.first];
+        if ( prv >= 0 ) path.back().second = -1;
+        if ( prv >= 0 ) r = prv;
+        else if ( score( r, j-1 ) + gap == h ) path.back().first = -1;
+        else assert( false );
+        if ( prv < 0 ) j--;
+    }
+    for ( int v : sub ) rank_[v] = -1;
+    reverse( path.begin(), path.end() );
+    return path;
+}
+
+string PoaGraph::getConsensus()
+{
+    // Heaviest bundle: follow each node's heaviest incoming edge, breaking ties on the better scoring predecessor
+    vector<int> score( nodes_.size(), 0 ), prv( nodes_.size(), -1 );
+    int best = -1;
+    for ( int v : order_ )
+    {
+        int weight = 0;
+        for ( pair<int, int>& e : nodes_[v].in_ ) if ( prv[v] < 0 || e.second > weight || ( e.second == weight && score[e.first] > score[ prv[v] ] ) )
+        {
+            prv[v] = e.first;
+            weight = e.second;
+        }
+        score[v] = prv[v] < 0 ? 0 : weight + score[ prv[v] ];
+        if ( best < 0 || score[v] >= score[best] ) best = v;
+    }
+    string seq;
+    for ( int v = best; v >= 0; v = prv[v] ) seq += nodes_[v].base_;
+    return string( seq.rbegin(), seq.rend() );
+}
+
+void PoaGraph::sort()
+{
+    vector<int> degree( nodes_.size(), 0 );
+    for ( Node& node : nodes_ ) for ( int r : node.out_ ) degree[r]++;
+    order_.clear();
+    for ( int i = 0; i < nodes_.size(); i++ ) if ( !degree[i] ) order_.push_back( i );
+    for ( int i = 0; i < order_.size(); i++ ) for ( int r : nodes_[ order_[i] ].out_ ) if ( !--degree[r] ) order_.push_back( r );
+    assert( order_.size() == nodes_.size() );
+    pos_.resize( nodes_.size() );
+    orderCoords_.resize( nodes_.size() );
+    for ( int i = 0; i < order_.size(); i++ ) pos_[ order_[i] ] = i;
+    for ( int i = 0; i < order_.size(); i++ ) orderCoords_[i] = nodes_[ order_[i] ].coord_;
+    sorted_ = true;
+}
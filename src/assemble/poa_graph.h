@@ -0,0 +1,54 @@
+/*
+ * Copyright (C) 2017 Glen T. Wilkins <glen.t.wilkins@gmail.com>
+ * Written by Glen T. Wilkins
+ * 
+ * This file is part of the consensible software package <https://github.com/gtwilkins/Consensible>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef POA_GRAPH_H
+#define POA_GRAPH_H
+
+#include "types.h"
+#include "match.h"
+
+// Partial-order alignment graph seeded with the stretch of target a cluster covers, with each read of the cluster then
+// aligned locally to the graph and merged into it. A read is only scored against nodes within band_ of its Match coords.
+class PoaGraph
+{
+    struct Node
+    {
+        Node( char base, int coord ): base_( base ), coord_( coord ){};
+        char base_;
+        int coord_;
+        vector< pair<int, int> > in_;
+        vector<int> out_, aligned_;
+    };
+    void addEdge( int l, int r, int weight );
+    int addNode( char base, int coord );
+    vector< pair<int, int> > align( string& seq, vector<int>& coords );
+    void sort();
+    vector<Node> nodes_;
+    vector<int> order_, orderCoords_, pos_, rank_;
+    vector<int16_t> rows_, profile_;
+    bool sorted_;
+    static const int band_ = 24;
+public:
+    PoaGraph( string& seq, int start, int end );
+    void addMatch( Match* m );
+    string getConsensus();
+};
+
+#endif /* POA_GRAPH_H */
@@ -19,9 +19,11 @@
  */
 
 #include "assemble.h"
+#include "edit_distance.h"
 #include "filenames.h"
 #include "match_query.h"
 #include "parameters.h"
+#include "thread_pool.h"
 #include "timer.h"
 #include "sequence_file.h"
 #include "shared_functions.h"
@@ -40,13 +42,57 @@
 extern Parameters params;
 
 Assemble::Assemble( Arguments& args )
-:ir_( NULL ), qb_( NULL )
 {
     string ifn, ofn, header, seq;
-    int errors = 15;
+    QueryOptions opts;
+    opts.maxNodes_ = args.maxNodes_;
+    opts.maxTime_ = args.maxTime_;
+    opts.targetCost_ = args.targetCost_;
+    opts.damage_ = args.damage_;
+    opts.maxDepth_ = args.maxDepth_;
+    uint64_t cached[2]{ 0, 0 };
     Filenames* fns = new Filenames( args.bwtPrefix_ );
-    ir_ = new IndexReader( fns );
-    qb_ = new QueryBinaries( fns );
+    int shards = max( 1, fns->getShards() );
+    
+    // Each shard's header loads its own parameters, so these are combined once all are open; a shard numbers its reads from zero,
+    // so its ids are offset by the read ends of all shards before it to stay unique once merged
+    ReadId seqCount = 0;
+    int readLen = 0;
+    for ( int i = 0; i < shards; i++ )
+    {
+        Filenames shard( shards > 1 ? Filenames::getShard( args.bwtPrefix_, i ) : args.bwtPrefix_ );
+        float cover = params.cover;
+        uint8_t flags[2];
+        memcpy( &flags[0], &params.isCalibrated, 1 );
+        params.libs.clear();
+        ir_.push_back( new IndexReader( &shard ) );
+        qb_.push_back( new QueryBinaries( &shard ) );
+        
+        // The calibration flag is read straight from a header byte that may hold values other than 0 or 1, so it is compared as a byte
+        memcpy( &flags[1], &params.isCalibrated, 1 );
+        if ( i && ( params.cover != cover || flags[0] != flags[1] ) )
+        {
+            cerr << endl << "Error: index shards disagree on coverage parameters; use --reindex to rebuild them." << endl;
+            exit( EXIT_FAILURE );
+        }
+        if ( shards > 1 && !params.libs.empty() )
+        {
+            cerr << endl << "Error: read libraries cannot be split across index shards; use --shards 1 to rebuild the index unsharded." << endl;
+            exit( EXIT_FAILURE );
+        }
+        offsets_.push_back( seqCount );
+        seqCount += params.seqCount;
+        readLen = max( readLen, params.readLen );
+    }
+    params.seqCount = seqCount;
+    params.readLen = readLen;
+    params.set();
+    
+    // Reads are spread evenly over shards, so each samples down to its share of the depth cap
+    if ( shards > 1 ) opts.maxDepth_ = ( opts.maxDepth_ + shards - 1 ) / shards;
+    vector<QueryOptions> shardOpts( shards, opts );
+    for ( int i = 0; i < shards; i++ ) shardOpts[i].cache_ = args.batchCache_ ? new IntervalCache( ir_[i], 18 ) : NULL;
+    ThreadPool pool( min( args.threads_, shards ) );
     
     Result result;
     for ( string& ifn : args.queries_ )
@@ -57,29 +103,61 @@ Assemble::Assemble( Arguments& args )
         while ( file.getSeq( is ) )
         {
             Target* tar = result.addTarget( is.header_, is.seq_ );
-            for ( Read r : MatchQuery( is.seq_, ir_, errors ).yield( qb_ ) ) result.addMatch( tar, r.id_, r.seq_, r.coords_[0] );
+            vector<MatchQuery*> mqs( shards );
+            pool.run( shards, [&]( int i ){ mqs[i] = new MatchQuery( is.seq_, ir_[i], shardOpts[i] ); } );
+            
+            // Report the most constrained plan over all shards
+            int errors[2]{ opts.errors_, opts.errors_ }, minHit = 0;
+            bool failure = false;
+            for ( MatchQuery* mq : mqs ) for ( int d : { 0, 1 } ) errors[d] = min( errors[d], mq->errors_[d] );
+            for ( MatchQuery* mq : mqs ) minHit = max( minHit, mq->minHit_ );
+            for ( MatchQuery* mq : mqs ) failure = failure || mq->failure_;
+            if ( errors[0] < opts.errors_ || minHit > min( (int)is.seq_.size(), 30 ) ) cout << "Search planned for query \"" << is.header_ << "\" with " << errors[0] << " errors per 100 bases and a minimum hit length of " << minHit << "." << endl;
+            if ( errors[1] < errors[0] ) cout << "Search budget exceeded for query \"" << is.header_ << "\"; error allowance reduced from " << errors[0] << " to " << errors[1] << " per 100 bases." << endl;
+            if ( failure ) cout << "Search budget exceeded for query \"" << is.header_ << "\" with no errors allowed; matches may be incomplete." << endl;
+            if ( args.stream_ ) result.stream( tar, mqs, qb_, offsets_, args.outPrefix_, args.threads_, args.poa_ );
+            else
+            {
+                vector< vector<Read> > found( shards );
+                pool.run( shards, [&]( int i ){ found[i] = mqs[i]->yield( qb_[i] ); } );
+                for ( int i = 0; i < shards; i++ ) for ( Read& r : found[i] ) r.id_ += offsets_[i];
+                for ( int i = 0; i < shards; i++ ) for ( Read& r : found[i] ) result.addMatch( tar, r, mqs[i]->errors_[1] );
+            }
+            uint64_t thinned = 0;
+            for ( MatchQuery* mq : mqs ) thinned += mq->thinned_;
+            if ( thinned ) cout << "Coverage above " << args.maxDepth_ << " for query \"" << is.header_ << "\"; " << thinned << " reads were sampled out before alignment." << endl;
+            for ( MatchQuery* mq : mqs ) if ( mq->ownCache_ ) cached[0] += mq->cache_->hits_;
+            for ( MatchQuery* mq : mqs ) if ( mq->ownCache_ ) cached[1] += mq->cache_->misses_;
+            for ( MatchQuery* mq : mqs ) delete mq;
             queryCount++;
             break;
         }
         cout << "Querying sequence data with " << to_string( queryCount ) << ( queryCount == 1 ? " query" : "queries") << " from: " << ifn << endl;
+        if ( args.batchCache_ ) cached[0] = cached[1] = 0;
+        for ( QueryOptions& o : shardOpts ) if ( o.cache_ ) cached[0] += o.cache_->hits_;
+        for ( QueryOptions& o : shardOpts ) if ( o.cache_ ) cached[1] += o.cache_->misses_;
+        if ( cached[0] + cached[1] ) cout << "    Interval cache hit rate: " << fixed << setprecision( 1 ) << ( 100.0 * cached[0] ) / ( cached[0] + cached[1] ) << "% of " << cached[0] + cached[1] << " rank queries." << endl;
+        if ( EditDistance::filtered_ ) cout << "    Edit distance prefilter rejected " << EditDistance::filtered_ << " of " << EditDistance::tested_ << " candidate realignments, skipping " << EditDistance::skipped_ << " alignment cells." << endl;
 //        ifstream ifs( ifn );
 //        while ( getSeq( ifs, header, seq ) )
 //        {
 //            Target* tar = result.addTarget( header, seq );
-//            for ( Read r : MatchQuery( seq, ir_, errors ).yield( qb_ ) ) result.addMatch( tar, r.id_, r.seq_, r.coords_[0] );
+//            for ( Read r : MatchQuery( seq, ir_, errors ).yield( qb_ ) ) result.addMatch( tar, r.id_, r.seq_, r.coords_[0], mq.errors_[1] );
 //            break;
 //        }
 //        break;
     }
 //    result.outputFullAlign( args.outPrefix_ );
-    result.assemble( args.outPrefix_ );
+    if ( args.stream_ ) result.finishStream();
+    else result.assemble( args.outPrefix_, args.threads_, args.poa_ );
+    for ( QueryOptions& o : shardOpts ) delete o.cache_;
     delete fns;
 }
 
 Assemble::~Assemble()
 {
-    delete ir_;
-    delete qb_;
+    for ( IndexReader* ir : ir_ ) delete ir;
+    for ( QueryBinaries* qb : qb_ ) delete qb;
 }
 
 void Assemble::printUsage()
@@ -35,8 +35,9 @@ public:
     
 private:
     void printUsage();
-    IndexReader* ir_;
-    QueryBinaries* qb_;
+    vector<IndexReader*> ir_;
+    vector<QueryBinaries*> qb_;
+    vector<ReadId> offsets_;
 };
 
 
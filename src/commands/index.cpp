@@ -20,6 +20,7 @@
 
 #include "index.h"
 #include "transform_structs.h"
+#include "thread_pool.h"
 #include <iostream>
 #include <sys/stat.h>
 #include <string.h>
@@ -30,33 +31,43 @@
 
 Index::Index( Arguments& args )
 {
-    PreprocessFiles* fns = new PreprocessFiles( args.bwtPrefix_, args.reindex_ );
-    bool isComplete = false, canResume = false, isIndexed = false, doRevComp = true;
-    int minScore = 0;
-    fns->getState( isComplete, canResume, isIndexed );
-    if ( args.reindex_ || ( !canResume && !isComplete ) )
+    // A sharded index keeps its shard count beside the unsharded files, and changing that count rebuilds every shard
+    Filenames base( args.bwtPrefix_ );
+    int built = base.getShards(), shards = args.shards_ ? args.shards_ : max( 1, built );
+    bool reindex = args.reindex_ || ( shards > 1 && shards != built ), doRevComp = true, collapsed = true;
+    vector<PreprocessFiles*> fns, loads;
+    vector<int> stages;
+    for ( int i = 0; i < shards; i++ )
     {
-        Transform::load( fns, args.input_, doRevComp );
-        Transform::run( fns );
-        IndexWriter idx( fns, 1024, 20000 );
+        bool isComplete = false, canResume = false, isIndexed = false;
+        fns.push_back( new PreprocessFiles( shards > 1 ? Filenames::getShard( args.bwtPrefix_, i ) : args.bwtPrefix_, reindex ) );
+        fns[i]->getState( isComplete, canResume, isIndexed );
+        stages.push_back( reindex || ( !canResume && !isComplete ) ? 3 : canResume ? 2 : !isIndexed ? 1 : 0 );
+        loads.push_back( stages[i] == 3 ? fns[i] : NULL );
     }
-    else if ( canResume  )
-    {
-        Transform::run( fns );
-        IndexWriter idx( fns, 1024, 20000 );
-    }
-    else if ( !isIndexed  )
-    {
-        IndexWriter idx( fns, 1024, 20000 );
-    }
-    else
+    bool existed = !*max_element( stages.begin(), stages.end() );
+    
+    // One pass over the input shares reads out among every shard still to be loaded, then each shard is transformed and indexed on its own thread
+    if ( shards > 1 && !existed ) cout << "Indexing sequence data in " << to_string( shards ) << " shards." << endl;
+    if ( count( stages.begin(), stages.end(), 3 ) ) Transform::load( loads, args.input_, doRevComp, args.collapse_ );
+    ThreadPool pool( min( args.threads_, shards ) );
+    pool.run( shards, [&]( int i ){
+        if ( stages[i] > 1 ) Transform::run( fns[i], shards == 1 );
+        if ( stages[i] > 0 ) IndexWriter idx( fns[i], 1024, 20000 );
+        if ( args.compressIds_ && Filenames::exists( fns[i]->ids ) ) Transform::compressIds( fns[i] );
+    } );
+    if ( shards > 1 && !existed ) cout << "Indexed all " << to_string( shards ) << " shards." << endl << endl;
+    for ( PreprocessFiles* fn : fns ) collapsed = collapsed && Filenames::exists( fn->mul );
+    for ( PreprocessFiles* fn : fns ) delete fn;
+    base.setShards( shards );
+    
+    if ( existed )
     {
         for ( string& fn : args.input_ ) cout << "Loading sequence data file: " << fn << endl;
         cout << "Index files already exist. Proceeding..." << endl << endl;
+        if ( args.collapse_ && !collapsed ) cout << "The existing index was built without --collapse; use --reindex to rebuild it with duplicates collapsed." << endl << endl;
     }
     
-    delete fns;
-    
 //    for ( int i ( 2 ); i < argc; i++ )
 //    {
 //        if ( !strcmp( argv[i], "-h" ) )
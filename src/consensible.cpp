@@ -41,6 +41,18 @@ void printUsage()
     cout << "\t-q\t(Required) Query file containing one or more query sequences." << endl;
     cout << "\t-w\t(Required) Working directory for temporary index files." << endl;
     cout << "\t-o\t(Optional) Output directory for results." << endl;
+    cout << "\t-t\t(Optional) Threads used to assemble consensus sequences (default: all available cores)." << endl;
+    cout << "\t--damage\t(Optional) Treat C->T transitions within this many bases of the read end where the search finishes as free, for ancient DNA; G->A transitions at the other end of a read still count as errors (default: 0, maximum: 63)." << endl;
+    cout << "\t--target-cost\t(Optional) Estimated search cost per query above which the error allowance and minimum hit length are adjusted (default: 5000000, 0 to disable)." << endl;
+    cout << "\t--batch-cache\t(Optional) Share one interval cache across all queries rather than one per query." << endl;
+    cout << "\t--collapse\t(Optional) When building the index, store identical reads and their reverse complements once, weighting each by its copy count during assembly." << endl;
+    cout << "\t--shards\t(Optional) Split the index into this many shards that are built in parallel and searched concurrently; changing the count rebuilds the index (default: 1, or the count an existing index was built with)." << endl;
+    cout << "\t--compress-ids\t(Optional) Bit-pack the index's read id file in blocks, roughly halving its size; also converts an existing index." << endl;
+    cout << "\t--poa\t(Optional) Call each cluster's consensus from a partial-order alignment of its reads instead of bubble resolution; clusters are not bridged, and each consensus stays within the query span its reads anchor to, so it may be shorter than the default." << endl;
+    cout << "\t--stream\t(Optional) Align reads and write each consensus as the search produces them, rather than holding every match in memory until the search ends." << endl;
+    cout << "\t--max-depth\t(Optional) Sample reads down to roughly this depth wherever coverage is deeper, before alignment; recurring variants are kept represented (default: 0, no limit)." << endl;
+    cout << "\t--max-nodes\t(Optional) Search steps allowed per query before the error allowance is reduced (default: 50000000, 0 for no limit)." << endl;
+    cout << "\t--max-time\t(Optional) Seconds allowed per query before the error allowance is reduced (default: 0, no limit); unlike --max-nodes, results may then vary with machine load." << endl;
     cout << endl << "Example command:" << endl;
     cout << "\tconsensible -i /myinputs/project101_data.fa -q /myinputs/interesting_gene.fa -w /mytempdata -o /myoutput" << endl;
     cout << endl << "Explanation:" << endl;
@@ -58,14 +58,14 @@ IndexReader::IndexReader( Filenames* fns )
     charRanks[3] = charRanks[2] + charCounts[2];
     
     // Load index
-    sizePerIndex = 37;
+    sizePerIndex = 33 + ID_SIZE;
     fread( &indexSize, 8, 1, idx );
     fread( &markSize, 8, 1, idx );
     index_ = new uint8_t[indexSize * sizePerIndex];
     marks_ = new ReadId[markSize];
     buff = new uint8_t[bwtPerIndex*2];
     fread( index_, 1, indexSize * sizePerIndex, idx );
-    fread( marks_, 4, markSize, idx );
+    fread( marks_, ID_SIZE, markSize, idx );
     
     runFlag = 1 << 7;
     runMask = ~runFlag;
@@ -173,7 +173,7 @@ void IndexReader::createSeeds( FILE* fp, int i, int it, int limit, CharId rank,
 {
     if ( it >= limit )
     {
-        ReadId outEdges = edge, outCount = count;
+        uint32_t outEdges = edge, outCount = count;
         fwrite( &rank, 8, 1, fp );
         fwrite( &outEdges, 4, 1, fp );
         fwrite( &outCount, 4, 1, fp );
@@ -186,6 +186,11 @@ void IndexReader::createSeeds( FILE* fp, int i, int it, int limit, CharId rank,
     for ( int j = 0; j < 4; j++ ) createSeeds( fp, j, it+1, limit, ranks[j], edges[j], counts[j] );
 }
 
+CharId IndexReader::getSize()
+{
+    return bwtSize;
+}
+
 int IndexReader::primeOverlap( uint8_t* q, CharId &rank, CharId &count )
 {
     if ( q[0] > 3 || q[1] > 3 )
@@ -227,7 +232,7 @@ int IndexReader::setBaseAll( vector<uint8_t> &q, CharId &rank, CharId &count )
         assert( q[i] < 4 );
         p += pow( 4, kmerLen - i - 1 ) * q[i] * 16;
     }
-    ReadId inEdge, inCount;
+    uint32_t inEdge, inCount;
     memcpy( &rank, &mers[p], 8 );
     memcpy( &inEdge, &mers[p+8], 4 );
     memcpy( &inCount, &mers[p+12], 4 );
@@ -242,6 +247,14 @@ void IndexReader::setBaseAll( uint8_t i, uint8_t j, CharId &rank, CharId &count
     count = baseCounts[ i + 1 ][j] - rank;
 }
 
+void IndexReader::setBaseAll( uint8_t i, BiRange &range )
+{
+    range.rank[0] = range.rank[1] = 0;
+    range.count = charCounts[i];
+    range.c[0] = i;
+    range.c[1] = 3-i;
+}
+
 void IndexReader::setBaseAll( uint8_t i, uint8_t j, CharId &rank, CharId &edge, CharId &count )
 {
     rank = baseCounts[i][j];
@@ -280,7 +293,7 @@ void IndexReader::setRank( uint8_t i, CharId rank, CharCount &ranks )
         while ( tmpTotal <= rank )
         {
             memcpy( &ranks.counts, &tmpRanks.counts, 32 );
-            memcpy( &ranks.endCounts, &tmpRanks.endCounts, 4 );
+            ranks.endCounts = tmpRanks.endCounts;
             totalCount = tmpTotal;
             ++rankIndex;
             if ( rank - totalCount < bwtPerIndex || rankIndex + 1 == indexSize ) break;
@@ -290,7 +303,7 @@ void IndexReader::setRank( uint8_t i, CharId rank, CharCount &ranks )
     
     CharId rankBwt = rankIndex * bwtPerIndex;
     CharId rankChunk = bwtPerIndex;
-    uint8_t offset = index_[(rankIndex * sizePerIndex)+36];
+    uint8_t offset = index_[(rankIndex * sizePerIndex)+sizePerIndex-1];
     rankBwt -= offset;
     rankChunk += offset;
     CharId rankLeft = rank - totalCount;
@@ -334,7 +347,7 @@ CharId IndexReader::setRankIndex( CharId rankIndex, CharCount &ranks )
 {
     CharId indexBegin = rankIndex * sizePerIndex;
     memcpy( &ranks.counts, &index_[indexBegin], 32 );
-    memcpy( &ranks.endCounts, &index_[indexBegin+32], 4 );
+    memcpy( &ranks.endCounts, &index_[indexBegin+32], ID_SIZE );
     return ( ranks[0] + ranks[1] + ranks[2] + ranks[3] + ranks.endCounts );
 }
 
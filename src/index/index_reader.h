@@ -34,10 +34,12 @@ public:
     void countRange( uint8_t i, CharId rank, CharId count, CharCount &ranks, CharCount &counts );
     void countRange( uint8_t i, CharId rank, CharId edge, CharId count, CharCount &ranks, CharCount &edges, CharCount &counts );
     void createSeeds( string &fn, int mer );
+    CharId getSize();
     int primeOverlap( uint8_t* q, CharId &rank, CharId &count );
     void primeOverlap( string &seq, vector<uint8_t> &q, CharId &rank, CharId &count, int &ol, bool drxn );
     int setBaseAll( vector<uint8_t> &q, CharId &rank, CharId &count );
     void setBaseAll( uint8_t i, uint8_t j, CharId &rank, CharId &count );
+    void setBaseAll( uint8_t i, BiRange &range );
     void setBaseAll( uint8_t i, uint8_t j, CharId &rank, CharId &edge, CharId &count );
     ReadId setBaseMap( uint8_t i, uint8_t j, CharId &rank, CharId &count );
     void setBaseOverlap( uint8_t i, uint8_t j, CharId &rank, CharId &count );
@@ -53,7 +55,7 @@ private:
     uint8_t* buff,* mers;
     
     CharId bwtSize, indexSize, markSize;
-    ReadId bwtPerIndex, indexPerMark;
+    uint32_t bwtPerIndex, indexPerMark;
     int kmerLen;
     uint8_t beginBwt, beginIdx;
     uint8_t sizePerIndex;
@@ -61,4 +61,15 @@ void CharCount::operator -=( CharCount &rhs )
 {
     for ( int i = 0; i < 4; i++ ) counts[i] -= rhs.counts[i];
     endCounts -= rhs.endCounts;
-}
\ No newline at end of file
+}
+
+void BiRange::extend( uint8_t i, bool drxn, CharCount &ranks, CharCount &counts )
+{
+    // The opposite strand gains the complementary base on its other end, so its interval narrows within itself
+    uint8_t j = drxn ? 3-i : i;
+    rank[!drxn] += counts.endCounts;
+    for ( int k = 0; k < 3-j; k++ ) rank[!drxn] += counts[3-k];
+    rank[drxn] = ranks[j];
+    count = counts[j];
+    c[drxn] = j;
+}
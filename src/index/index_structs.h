@@ -35,5 +35,13 @@ struct CharCount
     ReadId endCounts;
 };
 
+// Synchronised intervals of a sequence and its reverse complement, which the index always holds both of
+struct BiRange
+{
+    void extend( uint8_t i, bool drxn, CharCount &ranks, CharCount &counts );
+    CharId rank[2], count;
+    uint8_t c[2];
+};
+
 #endif /* INDEX_STRUCTS_H */
 
@@ -57,7 +57,7 @@ IndexWriter::IndexWriter( Filenames* fns )
     for ( int i ( 0 ); i < 4; i++ ) for ( int j ( 0 ); j < 63; j++ ) decodeBaseRun[ i * 63 + j ] = j + 1;
 }
 
-IndexWriter::IndexWriter( PreprocessFiles* fns, ReadId indexChunk, ReadId markChunk )
+IndexWriter::IndexWriter( PreprocessFiles* fns, uint32_t indexChunk, uint32_t markChunk )
 : bwtPerIndex( indexChunk ), countsPerMark( markChunk )
 {
     fns->setIndexWrite( bwt, idx );
@@ -184,7 +184,7 @@ void IndexWriter::writeIndex()
     ReadId endCount = counts[4];
     
     fwrite( &counts, 8, 4, idx );
-    fwrite( &endCount, 4, 1, idx );
+    fwrite( &endCount, ID_SIZE, 1, idx );
     fwrite( &currRunBytes, 1, 1, idx );         // Dummy offset
     
     CharId bwtLeft = bwtSize + 1;
@@ -217,7 +217,7 @@ void IndexWriter::writeIndex()
                 currRunBytes -= ( currChunkBytes - bwtPerIndex );
                 endCount = counts[4];
                 fwrite( &counts, 8, 4, idx );
-                fwrite( &endCount, 4, 1, idx );
+                fwrite( &endCount, ID_SIZE, 1, idx );
                 fwrite( &currRunBytes, 1, 1, idx );
                 currChunkBytes -= bwtPerIndex;
                 
@@ -248,7 +248,7 @@ void IndexWriter::writeIndex()
         exit( EXIT_FAILURE );
     }
     
-    fwrite( marks, 4, markCount, idx );
+    fwrite( marks, ID_SIZE, markCount, idx );
     
 //    cout << endl << "Indexing transformed data... completed!" << endl;
 //    cout << "Summary:" << endl;
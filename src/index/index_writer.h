@@ -29,10 +29,10 @@
 class IndexWriter
 {
 public:
-    IndexWriter( PreprocessFiles* fns, ReadId indexChunk, ReadId markChunk );
+    IndexWriter( PreprocessFiles* fns, uint32_t indexChunk, uint32_t markChunk );
     virtual ~IndexWriter();
     static void test( Filenames* fns );
-    static void write( PreprocessFiles* fns, ReadId indexChunk, ReadId markChunk );
+    static void write( PreprocessFiles* fns, uint32_t indexChunk, uint32_t markChunk );
     
 private:
     IndexWriter( Filenames* fns );
@@ -50,7 +50,7 @@ private:
     uint8_t contFlag, contMask;
     uint8_t bwtBegin;
     
-    ReadId bwtPerIndex, countsPerMark;
+    uint32_t bwtPerIndex, countsPerMark;
     ReadId basePos[4], markSizes[5];
     CharId indexSize, markSize;
     CharId currByte;
@@ -0,0 +1,47 @@
+/*
+ * Copyright (C) 2017 Glen T. Wilkins <glen.t.wilkins@gmail.com>
+ * Written by Glen T. Wilkins
+ * 
+ * This file is part of the consensible software package <https://github.com/gtwilkins/Consensible>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "interval_cache.h"
+
+IntervalCache::IntervalCache( IndexReader* ir, int bits )
+: hits_( 0 ), misses_( 0 ), ir_( ir ), slots_( 1ULL << bits ), shift_( 64 - bits )
+{}
+
+void IntervalCache::countRange( uint8_t c, CharId rank, CharId count, CharCount &ranks, CharCount &counts )
+{
+    if ( c > 3 ) return ir_->countRange( c, rank, count, ranks, counts );
+    
+    // Direct-mapped, so a colliding interval simply evicts the previous occupant
+    CachedInterval& slot = slots_[ ( ( rank * 0x9E3779B97F4A7C15ULL ) ^ ( ( ( count << 2 ) + c ) * 0xC2B2AE3D27D4EB4FULL ) ) >> shift_ ];
+    if ( slot.c_ == c && slot.rank_ == rank && slot.count_ == count )
+    {
+        ranks = slot.ranks_;
+        counts = slot.counts_;
+        hits_++;
+        return;
+    }
+    ir_->countRange( c, rank, count, ranks, counts );
+    slot.c_ = c;
+    slot.rank_ = rank;
+    slot.count_ = count;
+    slot.ranks_ = ranks;
+    slot.counts_ = counts;
+    misses_++;
+}
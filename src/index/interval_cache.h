@@ -0,0 +1,50 @@
+/*
+ * Copyright (C) 2017 Glen T. Wilkins <glen.t.wilkins@gmail.com>
+ * Written by Glen T. Wilkins
+ * 
+ * This file is part of the consensible software package <https://github.com/gtwilkins/Consensible>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef INTERVAL_CACHE_H
+#define INTERVAL_CACHE_H
+
+#include "types.h"
+#include "index_reader.h"
+
+struct CachedInterval
+{
+    CachedInterval(): rank_( 0 ), count_( 0 ), c_( 4 ){};
+    CharId rank_, count_;
+    CharCount ranks_, counts_;
+    uint8_t c_;
+};
+
+class IntervalCache
+{
+public:
+    IntervalCache( IndexReader* ir, int bits );
+    void countRange( uint8_t c, CharId rank, CharId count, CharCount &ranks, CharCount &counts );
+    
+    uint64_t hits_, misses_;
+    
+private:
+    IndexReader* ir_;
+    vector<CachedInterval> slots_;
+    int shift_;
+};
+
+#endif /* INTERVAL_CACHE_H */
+
@@ -26,7 +26,7 @@
 #include <iostream>
 
 Match::Match( Target* tar, MappedRead* read, AlignResult& ar, int tarCoord )
-: tar_( tar ), read_( read ), score_( ar.score_ )
+: tar_( tar ), read_( read ), map_( NULL ), score_( ar.score_ )
 {
     anchors_[0] = ar.lIgnore[1];
     anchors_[1] = read->seq_.size() - ar.rIgnore[1] - 1;
@@ -38,6 +38,15 @@ Match::Match( Target* tar, MappedRead* read, AlignResult& ar, int tarCoord )
     read_->matches_.push_back( this );
 }
 
+Match::Match( Target* tar, MappedRead* read, int anchors[2], int score, int tarCoord )
+: tar_( tar ), read_( read ), map_( NULL ), score_( score )
+{
+    anchors_[0] = anchors[0];
+    anchors_[1] = anchors[1];
+    for ( int i = 0; i < read->seq_.size(); i++ ) coords_.push_back( tarCoord+i );
+    read_->matches_.push_back( this );
+}
+
 //Match::Match( Target* tar, MappedRead* read, string t, string r, vector<pair<int,int>> &anchors, int tarCoord )
 //: tar_( tar ), read_( read ), score_( 0 )
 //{
@@ -134,6 +143,11 @@ int Match::getAnchor( int drxn )
     return coords_[anchors_[drxn]];
 }
 
+int Match::getWeight()
+{
+    return read_->count_;
+}
+
 vector<pair<int, int>> Match::getGaps()
 {
     vector<pair<int, int>> gaps;
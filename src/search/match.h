@@ -23,17 +23,21 @@
 
 #include "types.h"
 #include "align_result.h"
+#include "arena.h"
 
 class Target;
 struct MappedRead;
+struct ConMap;
 
-struct Match
+struct Match : ArenaObject<Match>
 {
     Match( Target* tar, MappedRead* read, AlignResult& ar, int tarCoord );
+    Match( Target* tar, MappedRead* read, int anchors[2], int score, int tarCoord );
 //    Match( Target* tar, MappedRead* read, string t, string r, vector<pair<int,int>> &anchors, int tarCoord );
     void anchorCoords( Match* match, vector< pair<int,int>>& coords );
     int getAnchor( int drxn );
     vector<pair<int,int>> getGaps();
+    int getWeight();
     static bool isBridge( Match* l, Match* r, AlignResult& result, int competingCons );
     bool isInsert( int coord );
     int size();
@@ -42,6 +46,7 @@ struct Match
     void updateCoords( Match* match, vector< pair<int,int>>& lcoords, vector< pair<int,int>>& rcoords );
     Target* tar_;
     MappedRead* read_;
+    ConMap* map_;
     vector<int> coords_;
     int anchors_[2], score_;
 };
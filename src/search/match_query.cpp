@@ -22,18 +22,24 @@
 #include "constants.h"
 #include "query_binary.h"
 #include "parameters.h"
+#include "shared_functions.h"
 #include <cassert>
 #include <iostream>
 #include <sys/stat.h>
 #include <chrono>
 #include <iomanip>
 #include <algorithm>
+#include <random>
 
 extern Parameters params;
 
-MatchQuery::MatchQuery( string seq, IndexReader* ir, int errors )
-: ir_( ir ), len_( seq.size() ), failure_( false )
+MatchQuery::MatchQuery( string seq, IndexReader* ir, QueryOptions& opts )
+: ir_( ir ), seq_( seq ), len_( seq.size() ), maxNodes_( opts.maxNodes_ ), maxTime_( opts.maxTime_ ), damage_( opts.damage_ ), maxDepth_( opts.maxDepth_ ), cache_( opts.cache_ ), minHit_( min( len_, 30 ) ), errors_{ opts.errors_, opts.errors_ }, thinned_( 0 ), failure_( false ), ownCache_( !cache_ )
 {
+    // Distinct intervals grow with query length, so short queries get a proportionally smaller cache
+    int bits = 10;
+    while ( bits < 16 && ( 1 << bits ) < len_ * 32 ) bits++;
+    if ( ownCache_ ) cache_ = new IntervalCache( ir, bits );
     q_[0].resize( seq.size(), 0 );
     q_[1].resize( seq.size(), 0 );
     for ( int i = 0; i < seq.size(); i++ )
@@ -41,58 +47,192 @@ MatchQuery::MatchQuery( string seq, IndexReader* ir, int errors )
         q_[0][i] = 3 - charToInt[ seq[i] ];
         q_[1][i] = charToInt[ seq.end()[-i-1] ];
     }
-    match( errors );
+    if ( opts.targetCost_ ) plan( opts.targetCost_ );
+    match( errors_[1] );
+    
+    // Out of budget, so retry with a halved error allowance and thus longer exact seeds
+    while ( failure_ && errors_[1] )
+    {
+        for ( int d : { 0, 1 } ) hits_[d].clear();
+        failure_ = false;
+        match( errors_[1] /= 2 );
+    }
 }
 
-void MatchQuery::match( int errors )
+MatchQuery::~MatchQuery()
+{
+    if ( ownCache_ ) delete cache_;
+}
+
+double MatchQuery::estimate( int errors, vector<double>& ends )
+{
+    int dBlocks[2];
+    setBlocks( errors, dBlocks );
+    
+    // Typical interval size part way into a read approximates coverage, so any excess reflects repeat copies
+    vector<CharId> covers;
+    for ( int d : { 0, 1 } ) for ( int i = 0; i < dBlocks[d]; i++ ) if ( getPath( d, blocks_[d][i] ).size() > 18 ) covers.push_back( getPath( d, blocks_[d][i] )[18].first );
+    sort( covers.begin(), covers.end() );
+    double nodes = 0, size = ir_->getSize(), cover = covers.empty() ? 1 : max( (CharId)1, covers[ covers.size() / 2 ] );
+    
+    for ( int d : { 0, 1 } ) for ( int i = 0; i < dBlocks[d]; i++ )
+    {
+        int s = blocks_[d][i];
+        vector< pair<CharId, ReadId> >& path = getPath( d, s );
+        for ( int l = 2, j = i+1; l <= min( len_-s, params.readLen ); l++ )
+        {
+            while ( j < blocks_[d].size() && blocks_[d][j] <= s+l-1 ) j++;
+            double count = l-2 < path.size() ? path[l-2].first : 0, copies = max( 0.0, count / cover - 1 ), random = size * pow( 0.25, l ), branches = 1;
+            if ( l-2 < path.size() ) ends[l] += path[l-2].second;
+            
+            // Expected branches with m mismatches: C(f,m)*3^m, of which a fraction exist by chance, as read errors or as diverged repeat copies
+            for ( int m = 0, f = max( 0, s+l-blocks_[d][i+1] ); m <= min( j-i-1, f ); m++ )
+            {
+                nodes += branches * min( 1.0, random + count * pow( 0.003, m ) + copies * pow( 0.015, m ) );
+                branches *= 3.0 * ( f-m ) / ( m+1 );
+            }
+        }
+    }
+    return nodes;
+}
+
+vector< pair<CharId, ReadId> >& MatchQuery::getPath( int d, int s )
+{
+    auto ins = paths_[d].insert( make_pair( s, vector< pair<CharId, ReadId> >() ) );
+    if ( !ins.second || s+1 >= len_ ) return ins.first->second;
+    
+    CharId rank, count;
+    CharCount ranks, counts;
+    uint8_t c = q_[d][s+1];
+    ir_->setBaseAll( q_[d][s], c, rank, count );
+    for ( int i = s+1; count && i < min( len_, s+params.readLen ); i++ )
+    {
+        cache_->countRange( c, rank, count, ranks, counts );
+        ins.first->second.push_back( make_pair( count, counts.endCounts ) );
+        if ( i+1 >= len_ ) break;
+        c = q_[d][i+1];
+        rank = ranks[c];
+        count = counts[c];
+    }
+    return ins.first->second;
+}
+
+void MatchQuery::plan( double target )
+{
+    // Each matched read costs roughly a few hundred rank calls to fetch and align
+    double hitCost = 256, nodes;
+    vector<double> ends( max( len_, params.readLen ) + 1, 0 );
+    while ( ( nodes = estimate( errors_[1], ends ) ) > target && errors_[1] )
+    {
+        errors_[1] = errors_[1] * 2 / 3;
+        ends.assign( ends.size(), 0 );
+    }
+    
+    // Repetitive queries match too many reads, so require longer hits until the read count fits the target too
+    double reads = 0;
+    for ( int l = minHit_+1; l < ends.size(); l++ ) reads += ends[l];
+    for ( int limit = min( len_, max( minHit_, params.readLen / 2 ) ); minHit_ < limit && nodes + reads * hitCost > target; minHit_++ ) reads -= ends[ minHit_+1 ];
+    errors_[0] = errors_[1];
+}
+
+int MatchQuery::setBlocks( int errors, int dBlocks[2] )
 {
     int blockSize = min( min( len_, 100 ), max ( 6, 100 / ( errors+1 ) ) );
     int blockCount = len_ / blockSize;
     int blockExtra = len_ - ( blockSize * blockCount );
     int extraBegin = max( 0, ( ( blockCount+1 ) / 2 ) - ( ( blockExtra+1 ) / 2 ) );
-    int dBlocks[2]{ ( 1 + blockCount ) / 2, max( 1, blockCount / 2 ) };
+    dBlocks[0] = ( 1 + blockCount ) / 2;
+    dBlocks[1] = max( 1, blockCount / 2 );
     assert( blockExtra >= 0 );
     
+    for ( int d : { 0, 1 } ) blocks_[d].clear();
     blocks_[0].push_back( 0 );
     for ( int i = 0; i < blockCount; i++ ) blocks_[0].push_back( blocks_[0].back() + blockSize + ( i > extraBegin && blockExtra && blockExtra-- ) );
     for ( int i = 0; i < blocks_[0].size(); i++ ) blocks_[1].push_back( len_ - blocks_[0].end()[-i-1] );
     
+    return blockCount;
+}
+
+void MatchQuery::match( int errors )
+{
+    int dBlocks[2], blockCount = setBlocks( errors, dBlocks );
+    
     int queried = 0;
-//    auto t_start = std::chrono::high_resolution_clock::now();
+    nodes_ = 0;
+    start_ = chrono::steady_clock::now();
     for ( int d : { 0, 1 } ) for ( int i = 0; !failure_ && i < dBlocks[d]; i++ )
     {
         CharId rank, count;
         ir_->setBaseAll( q_[d][ blocks_[d][i] ], q_[d][ blocks_[d][i]+1 ], rank, count );
         
         bool seed = !i && min( errors, blockCount ) > 2;
-        query( rank, count, q_[d][ blocks_[d][i]+1 ], blocks_[d][i]+1, i, 1, seed, d );
+        query( rank, count, q_[d][ blocks_[d][i]+1 ], blocks_[d][i]+1, i, 1, seed, d, 0 );
         queried++;
-        if ( seed ) for ( int j : { 0, 1 } ) for ( int k = 0; k < 4; k++ ) if ( k != q_[d][j] )
-        {
-            ir_->setBaseAll( j ? q_[d][0] : k, j ? k : q_[d][1], rank, count );
-            query( rank, count, j ? k : q_[d][1], blocks_[d][1], 1, 1, 0, d );
-            queried++;
-        }
+        if ( seed ) queried += substitute( d );
         if ( seed ) i++;
-//        if ( double( ( ( std::chrono::high_resolution_clock::now() - t_start ).count() / 1000.0 ) / CLOCKS_PER_SEC ) > 3 ) failure_ = true;
     }
 }
 
-bool MatchQuery::query( CharId rank, CharId count, uint8_t c, int i, int j, int len, int errLeft, int d )
+void MatchQuery::extend( BiRange& range, uint8_t c, bool drxn )
+{
+    CharCount ranks, counts;
+    cache_->countRange( range.c[drxn], range.rank[drxn], range.count, ranks, counts );
+    range.extend( c, drxn, ranks, counts );
+    nodes_++;
+}
+
+int MatchQuery::substitute( int d )
+{
+    // Match the rest of the first block once from its third base, then extend it forwards over each substitution of the first two bases
+    BiRange base, exact, range;
+    ir_->setBaseAll( q_[d][2], base );
+    for ( int i = 3; base.count && i < blocks_[d][1]; i++ ) extend( base, q_[d][i], 0 );
+    if ( !base.count ) return 0;
+    extend( exact = base, q_[d][1], 1 );
+    
+    int queried = 0;
+    for ( int j : { 0, 1 } ) for ( int k = 0; k < 4; k++ ) if ( k != q_[d][j] )
+    {
+        range = j ? base : exact;
+        extend( range, k, 1 );
+        if ( j ) extend( range, q_[d][0], 1 );
+        if ( range.count && ++queried ) query( range.rank[0], range.count, range.c[0], blocks_[d][1]-1, 0, blocks_[d][1]-1, 0, d, 0 );
+    }
+    return queried;
+}
+
+bool MatchQuery::spent()
 {
+    if ( maxNodes_ && nodes_ > maxNodes_ ) failure_ = true;
+    if ( maxTime_ && !( nodes_ & 1023 ) && chrono::duration<double>( chrono::steady_clock::now() - start_ ).count() > maxTime_ ) failure_ = true;
+    return failure_;
+}
+
+bool MatchQuery::query( CharId rank, CharId count, uint8_t c, int i, int j, int len, int errLeft, int d, uint64_t damage )
+{
+    if ( ++nodes_ && spent() ) return false;
+    
+    // A free transition that has fallen outside the terminal window is charged as an ordinary error; only the read end the
+    // search reaches last is known here, as a search starts wherever its seed block falls within a read, so G->A is never free
+    if ( ( damage >> damage_ ) & 1 && !errLeft-- ) return true;
+    damage &= ( 1ULL << damage_ ) - 1;
+    
     CharCount ranks, counts;
-    ir_->countRange( c, rank, count, ranks, counts );
+    cache_->countRange( c, rank, count, ranks, counts );
     i++;
     
-    if ( ( ++len > min( len_, 30 ) ) && counts.endCounts ) QueryHit( ranks.endCounts, counts.endCounts, d ? len_-i : i, hits_[d] );
+    if ( ++len > minHit_ && counts.endCounts ) QueryHit( ranks.endCounts, counts.endCounts, d ? len_-i : i, hits_[d] );
     
     if ( j < blocks_[d].size() && i >= blocks_[d][j+1] && ++j ) errLeft++;
     
     for ( int k = 0; k < 4; k++ ) if ( counts[k] )
     {
-        if ( i >= len_ || k == q_[d][i] ) query( ranks[k], counts[k], k, i, j, len, errLeft, d );
-        else if ( errLeft ) query( ranks[k], counts[k], k, i, j, len, errLeft-1, d );
+        if ( i >= len_ || k == q_[d][i] ) query( ranks[k], counts[k], k, i, j, len, errLeft, d, damage << 1 );
+        else if ( damage_ && q_[d][i] == 1 && k == 3 ) query( ranks[k], counts[k], k, i, j, len, errLeft, d, damage << 1 | 1 );
+        else if ( errLeft ) query( ranks[k], counts[k], k, i, j, len, errLeft-1, d, damage << 1 );
     }
+    
+    return !failure_;
 }
 
 //vector<MatchRead> MatchQuery::yield( QueryBinaries* qb )
@@ -110,20 +250,121 @@ bool MatchQuery::query( CharId rank, CharId count, uint8_t c, int i, int j, int
 //    return reads;
 //}
 
+int MatchQuery::getWindow( int key )
+{
+    // One read length per window, so the reads keyed to a window approximate the depth across it
+    return ( key - ( key < 0 ? params.readLen-1 : 0 ) ) / params.readLen;
+}
+
+void MatchQuery::sample( vector< pair<int, Read> >& reads )
+{
+    vector< pair<int, Read> > kept;
+    for ( int i = 0, j; i < reads.size(); i = j )
+    {
+        for ( j = i; j < reads.size() && getWindow( reads[j].first ) == getWindow( reads[i].first ); j++ );
+        int n = j-i, minSupport = max( 2, ( n + maxDepth_ - 1 ) / maxDepth_ );
+        if ( n <= maxDepth_ ) for ( int k = i; k < j; k++ ) kept.push_back( move( reads[k] ) );
+        if ( n <= maxDepth_ ) continue;
+        
+        // Differences from the template on each read's hit diagonal that recur often enough to survive a proportional sample are taken as variants
+        vector< vector<int> > alleles( n );
+        unordered_map<int, int> support;
+        for ( int k = 0; k < n; k++ )
+        {
+            Read& r = reads[i+k].second;
+            if ( r.coords_[0] < 0 || r.coords_[0] + r.seq_.size() > seq_.size() ) continue;
+            for ( int m : getMismatches( seq_, r.coords_[0], r.seq_, r.seq_.size() / 10 ) ) alleles[k].push_back( ( r.coords_[0] + m )*4 + charToInt[ r.seq_[m] ] );
+            for ( int a : alleles[k] ) support[a]++;
+        }
+        
+        // Each read is grouped by the rarest variant it carries, and every group is sampled at the same rate but never emptied
+        vector< pair<int, int> > groups;
+        for ( int k = 0; k < n; k++ )
+        {
+            int group = -1, best = n+1;
+            for ( int a : alleles[k] ) if ( support[a] >= minSupport && support[a] < best ) best = support[ group = a ];
+            groups.push_back( make_pair( group, k ) );
+        }
+        sort( groups.begin(), groups.end() );
+        mt19937 rng( getWindow( reads[i].first ) );
+        vector<bool> keep( n, false );
+        for ( int g = 0, h; g < n; g = h )
+        {
+            for ( h = g; h < n && groups[h].first == groups[g].first; h++ );
+            int limit = ( ( h-g ) * maxDepth_ + n-1 ) / n;
+            for ( int k : getReservoirSample( h-g, limit, rng ) ) keep[ groups[g+k].second ] = true;
+        }
+        for ( int k = 0; k < n; k++ ) if ( keep[k] ) kept.push_back( move( reads[i+k] ) );
+        thinned_ += n - count( keep.begin(), keep.end(), true );
+    }
+    reads = move( kept );
+}
+
 vector<Read> MatchQuery::yield( QueryBinaries* qb )
 {
     vector<Read> reads;
+    vector<int> keys;
     unordered_set<ReadId> used;
     for ( int d : { 0, 1 } ) for ( QueryHit& qh : hits_[d] ) for ( ReadId id : qb->getIds( qh.rank_, qh.count_ ) )
     {
         if ( !used.insert( id = ( d ? id : params.getRevId( id ) ) ).second ) continue;
         reads.push_back( Read( qb ? qb->getSequence( id ) : "", id, qh.coord_, qh.coord_ ) );
         reads.back().coords_[d] += ( d ? reads.back().seq_.size() : -reads.back().seq_.size() );
+        reads.back().count_ = qb ? qb->getCount( id ) : 1;
+        keys.push_back( d ? qh.coord_ : qh.coord_ - params.readLen );
     }
     for ( int i = 0; i > reads.size(); i++ ) if ( params.isReadMp( reads[i].id_ ) ) reads.erase( reads.begin() + i-- );
+    if ( !maxDepth_ ) return reads;
+    
+    vector< pair<int, int> > order;
+    vector< pair<int, Read> > keyed;
+    for ( int i = 0; i < reads.size(); i++ ) order.push_back( make_pair( keys[i], i ) );
+    sort( order.begin(), order.end() );
+    for ( pair<int, int>& o : order ) keyed.push_back( make_pair( o.first, move( reads[o.second] ) ) );
+    sample( keyed );
+    reads.clear();
+    for ( pair<int, Read>& k : keyed ) reads.push_back( move( k.second ) );
     return reads;
 }
 
+void MatchQuery::yield( QueryBinaries* qb, BoundedQueue< pair<int, Read> >& queue )
+{
+    // Ids are gathered up front so that duplicates resolve as above, but sequences are only decoded as the queue drains
+    vector<Read> reads;
+    vector< pair<int, int> > order;
+    vector<int> drxns;
+    unordered_set<ReadId> used;
+    for ( int d : { 0, 1 } ) for ( QueryHit& qh : hits_[d] ) for ( ReadId id : qb->getIds( qh.rank_, qh.count_ ) )
+    {
+        if ( !used.insert( id = ( d ? id : params.getRevId( id ) ) ).second ) continue;
+        order.push_back( make_pair( d ? qh.coord_ : qh.coord_ - params.readLen, reads.size() ) );
+        reads.push_back( Read( "", id, qh.coord_, qh.coord_ ) );
+        drxns.push_back( d );
+    }
+    
+    // Keyed on the lowest start each read could have, so every key is a floor on the starts of all reads still to come
+    sort( order.begin(), order.end() );
+    vector< pair<int, Read> > window;
+    for ( int i = 0; i <= order.size(); i++ )
+    {
+        // A window is only thinned once it is complete, which is whenever the next key moves into a new one
+        if ( !window.empty() && ( !maxDepth_ || i == order.size() || getWindow( order[i].first ) != getWindow( window[0].first ) ) )
+        {
+            if ( maxDepth_ ) sample( window );
+            for ( pair<int, Read>& w : window ) queue.push( move( w ) );
+            window.clear();
+        }
+        if ( i == order.size() ) break;
+        Read& r = reads[ order[i].second ];
+        int d = drxns[ order[i].second ];
+        r.seq_ = qb->getSequence( r.id_ );
+        r.count_ = qb->getCount( r.id_ );
+        r.coords_[d] += ( d ? r.seq_.size() : -r.seq_.size() );
+        window.push_back( make_pair( order[i].first, move( r ) ) );
+    }
+    queue.close();
+}
+
 //MatchedQuery::MatchedQuery( string header, string seq, IndexReader* ir, QueryBinaries* qb, int errors )
 //: header_( header ), seq_( seq )
 //{
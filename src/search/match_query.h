@@ -23,9 +23,12 @@
 
 #include "types.h"
 #include "index_reader.h"
+#include "interval_cache.h"
+#include "bounded_queue.h"
 #include "query_binary.h"
 #include "query_structs.h"
 #include "shared_structs.h"
+#include <chrono>
 
 struct MatchRead
 {
@@ -37,20 +40,42 @@ struct MatchRead
 
 class MatchQuery
 {
-    bool query( CharId rank, CharId count, uint8_t c, int i, int j, int len, int errLeft, int d );
+    double estimate( int errors, vector<double>& ends );
+    void extend( BiRange& range, uint8_t c, bool drxn );
+    vector< pair<CharId, ReadId> >& getPath( int d, int s );
+    int getWindow( int key );
+    bool query( CharId rank, CharId count, uint8_t c, int i, int j, int len, int errLeft, int d, uint64_t damage );
     void match( int errors );
+    void plan( double target );
+    void sample( vector< pair<int, Read> >& reads );
+    int setBlocks( int errors, int dBlocks[2] );
+    bool spent();
+    int substitute( int d );
     
     IndexReader* ir_;
+    string seq_;
     vector<uint8_t> q_[2];
     vector<int> blocks_[2];
     vector<QueryHit> hits_[2];
+    unordered_map<int, vector< pair<CharId, ReadId> > > paths_[2];
     int len_;
+    uint64_t nodes_, maxNodes_;
+    double maxTime_;
+    int damage_, maxDepth_;
+    chrono::steady_clock::time_point start_;
     
 public:
-    MatchQuery( string seq, IndexReader* ir, int errors );
+    MatchQuery( string seq, IndexReader* ir, QueryOptions& opts );
+    MatchQuery( const MatchQuery& ) = delete;
+    MatchQuery& operator=( const MatchQuery& ) = delete;
+    ~MatchQuery();
 //    vector<MatchRead> yield( QueryBinaries* qb );
     vector<Read> yield( QueryBinaries* qb );
-    bool failure_;
+    void yield( QueryBinaries* qb, BoundedQueue< pair<int, Read> >& queue );
+    IntervalCache* cache_;
+    int minHit_, errors_[2];
+    uint64_t thinned_;
+    bool failure_, ownCache_;
 };
 
 //struct MatchedQuery
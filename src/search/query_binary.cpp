@@ -29,19 +29,29 @@ extern Parameters params;
 QueryBinaries::QueryBinaries( Filenames* fns )
 {
     bin_ = fns->getBinary( true, false );
-    ids_ = fns->getReadPointer( fns->ids, false );
+    idc_ = fns->getReadPointer( fns->idc, false, true );
+    ids_ = idc_ ? idc_ : fns->getReadPointer( fns->ids, false );
     
-    uint64_t binId, idsId;
+    uint64_t binId, idsId, idsCount;
     fread( &binBegin_, 1, 1, bin_ );
     fread( &binId, 8, 1, bin_ );
     fread( &idsBegin_, 1, 1, ids_ );
     fread( &idsId, 8, 1, ids_ );
+    if ( idc_ ) fread( &idsCount, 8, 1, idc_ );
+    if ( idc_ ) fread( &idsBlock_, 4, 1, idc_ );
     if ( binId != idsId )
     {
         cerr << endl << "Error: disagreement among input files." << endl;
         exit( EXIT_FAILURE );
     }
     
+    // Read multiplicities only exist for an index built with duplicates collapsed
+    uint64_t mulId = 0;
+    mul_ = fns->getReadPointer( fns->mul, false, true );
+    if ( mul_ ) fread( &mulId, 8, 1, mul_ );
+    if ( mul_ && mulId != binId ) fclose( mul_ );
+    if ( mulId != binId ) mul_ = NULL;
+    
     uint8_t libCount, readLen, cycles;
     uint32_t coverage;
     fread( &readLen, 1, 1, bin_ );
@@ -56,14 +66,14 @@ QueryBinaries::QueryBinaries( Filenames* fns )
     fread( &params.isCalibrated, 1, 1, bin_ );
     fread( &coverage, 4, 1, bin_ );
     params.cover = (float)coverage / (float)100000;
-    fread( &params.seqCount, 4, 1, bin_ );
+    fread( &params.seqCount, ID_SIZE, 1, bin_ );
     fread( &libCount, 1, 1, bin_ );
     ReadId countSoFar = 0;
     for ( int i ( 0 ); i < libCount; i++ )
     {
         Lib lib;
         uint16_t libMed, libMin, libMax;
-        fread( &lib.count, 4, 1, bin_ );
+        fread( &lib.count, ID_SIZE, 1, bin_ );
         fread( &libMed, 2, 1, bin_ );
         fread( &libMin, 2, 1, bin_ );
         fread( &libMax, 2, 1, bin_ );
@@ -118,13 +128,23 @@ string QueryBinaries::getSequence( ReadId id )
     return seq;
 }
 
+uint32_t QueryBinaries::getCount( ReadId id )
+{
+    uint32_t count = 1;
+    if ( !mul_ ) return count;
+    fseek( mul_, 8 + CharId( id / 2 ) * 4, SEEK_SET );
+    fread( &count, 4, 1, mul_ );
+    return count;
+}
+
 vector<ReadId> QueryBinaries::getIds( CharId rank, CharId count )
 {
+    if ( idc_ ) return getPackedIds( rank, count );
     vector<ReadId> readIds( count );
     ReadId idBuff[count];
-    CharId seekId = rank * 4 + idsBegin_;
+    CharId seekId = rank * ID_SIZE + idsBegin_;
     fseek( ids_, seekId, SEEK_SET );
-    fread( &idBuff, 4, count, ids_ );
+    fread( &idBuff, ID_SIZE, count, ids_ );
     for ( int i ( 0 ); i < count; i++ )
     {
         readIds[i] = idBuff[i];
@@ -132,6 +152,38 @@ vector<ReadId> QueryBinaries::getIds( CharId rank, CharId count )
     return readIds;
 }
 
+vector<ReadId> QueryBinaries::getPackedIds( CharId rank, CharId count )
+{
+    vector<ReadId> readIds;
+    if ( !count ) return readIds;
+    readIds.reserve( count );
+    
+    // Only the blocks spanning the rank range are read, and within them only the requested ids are unpacked
+    CharId first = rank / idsBlock_, last = ( rank + count - 1 ) / idsBlock_;
+    vector<uint64_t> offsets( last - first + 2 );
+    fseek( idc_, idsBegin_ + first * 8, SEEK_SET );
+    fread( offsets.data(), 8, offsets.size(), idc_ );
+    vector<uint8_t> buff( offsets.back() - offsets[0] + 8, 0 );
+    fseek( idc_, offsets[0], SEEK_SET );
+    fread( buff.data(), 1, offsets.back() - offsets[0], idc_ );
+    
+    for ( CharId b = first; b <= last; b++ )
+    {
+        uint8_t* block = &buff[ offsets[b-first] - offsets[0] ];
+        uint8_t width = block[ID_SIZE];
+        ReadId base;
+        memcpy( &base, block, ID_SIZE );
+        uint64_t mask = ( uint64_t( 1 ) << width ) - 1, bits;
+        CharId i = b == first ? rank % idsBlock_ : 0, j = b == last ? ( rank + count - 1 ) % idsBlock_ + 1 : idsBlock_;
+        for ( ; i < j; i++ )
+        {
+            memcpy( &bits, block + ID_SIZE + 1 + i * width / 8, 8 );
+            readIds.push_back( base + ( ( bits >> ( i * width % 8 ) ) & mask ) );
+        }
+    }
+    
+    return readIds;
+}
 
 void QueryBinaries::set()
 {
@@ -31,13 +31,16 @@ public:
     ~QueryBinaries(){};
     vector<ReadId> getIds( CharId ranks, CharId counts );
     string getSequence( ReadId id );
+    uint32_t getCount( ReadId id );
     
 private:
+    vector<ReadId> getPackedIds( CharId rank, CharId count );
     void decodeSequence( uint8_t* line, string &seq, uint8_t extLen, bool isRev, bool drxn );
     void set();
     
-    FILE* bin_,* ids_;
+    FILE* bin_,* ids_,* idc_,* mul_;
     uint8_t binBegin_, idsBegin_, lineLen_;
+    uint32_t idsBlock_;
     
     char decodeFwd[4][256];
     char decodeRev[4][256];
@@ -23,6 +23,8 @@
 
 #include "types.h"
 
+class IntervalCache;
+
 struct QueryHit
 {
     QueryHit( ReadId rank, ReadId count, int coord );
@@ -31,6 +33,15 @@ struct QueryHit
     int coord_;
 };
 
+struct QueryOptions
+{
+    QueryOptions(): errors_( 15 ), damage_( 0 ), maxDepth_( 0 ), maxNodes_( 0 ), maxTime_( 0 ), targetCost_( 0 ), cache_( NULL ){};
+    int errors_, damage_, maxDepth_;
+    uint64_t maxNodes_;
+    double maxTime_, targetCost_;
+    IntervalCache* cache_;
+};
+
 
 #endif /* QUERY_STRUCTS_H */
 
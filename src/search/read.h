@@ -25,10 +25,11 @@
 
 struct MappedRead
 {
-    MappedRead( ReadId id, string seq ):id_( id ), seq_( seq ){};
+    MappedRead( ReadId id, string seq, uint32_t count ): seq_( seq ), id_( id ), count_( count ){};
     string seq_;
     vector<Match*> matches_;
     ReadId id_;
+    uint32_t count_;
 };
 
 
@@ -19,26 +19,45 @@
  */
 
 #include "result.h"
+#include "thread_pool.h"
+#include "parameters.h"
 #include "fstream"
 #include <iostream>
+#include <thread>
+#include <algorithm>
+
+extern Parameters params;
 
 Result::~Result()
 {
     for ( auto read : reads_ ) delete read.second;
+    for ( Target* tar : targets_ ) delete tar;
 }
 
-MappedRead* Result::addRead( ReadId id, string seq )
+MappedRead* Result::addRead( ReadId id, string seq, uint32_t count )
 {
     auto it = reads_.find( id );
     if ( it != reads_.end() ) return it->second;
-    MappedRead* read = new MappedRead( id, seq );
+    MappedRead* read = new MappedRead( id, seq, count );
     reads_.insert( make_pair( id, read ) );
     return read;
 }
 
-void Result::addMatch( Target* tar, ReadId id, string seq, int coord )
+void Result::addMatch( Target* tar, Read& r, int errors )
 {
-    tar->addMatch( addRead( id, seq ), coord );
+    tar->addMatch( addRead( r.id_, r.seq_, r.count_ ), r.coords_[0], errors );
+}
+
+string Result::getOutName( string& outPrefix )
+{
+    string ofn = outPrefix + "_consensus.fa";
+    size_t it = outPrefix.find_last_of( '.' );
+    if ( it != string::npos )
+    {
+        string excess = outPrefix.substr( it+1 );
+        if ( excess == "fasta" || excess == "fa" ) ofn = outPrefix;
+    }
+    return ofn;
 }
 
 Target* Result::addTarget( string header, string seq )
@@ -48,34 +67,126 @@ Target* Result::addTarget( string header, string seq )
     return tar;
 }
 
-void Result::assemble( string& outPrefix )
+void Result::assemble( string& outPrefix, int threads, bool poa )
 {
+    // Clusters are independent until bridged, and bridging only joins neighbours within a target
+    ThreadPool pool( threads );
+    vector<vector<Match*>> clusters;
+    vector<int> owners, firsts;
+    for ( int i = 0; i < targets_.size(); i++ )
+    {
+        firsts.push_back( clusters.size() );
+        for ( vector<Match*>& c : targets_[i]->getClusters() ) clusters.push_back( c );
+        owners.resize( clusters.size(), i );
+    }
+    firsts.push_back( clusters.size() );
+    vector<string> seqs;
     vector<Consensus*> consensus;
-    for ( Target* tar : targets_ )
+    vector<Target*> tars;
+    if ( poa )
     {
-        for ( Consensus* c : tar->assemble() ) consensus.push_back( c );
+        seqs.resize( clusters.size() );
+        pool.run( clusters.size(), [&]( int i ){ seqs[i] = targets_[ owners[i] ]->assemblePoa( clusters[i] ); } );
     }
-    string ofn = outPrefix + "_consensus.fa";
-    size_t it = outPrefix.find_last_of( '.' );
-    if ( it != string::npos )
+    else
     {
-        string excess = outPrefix.substr( it+1 );
-        if ( excess == "fasta" || excess == "fa" ) ofn = outPrefix;
+        vector<Consensus*> built( clusters.size() );
+        vector< vector<Consensus*> > bridged( targets_.size() );
+        pool.run( clusters.size(), [&]( int i ){ Arena::Scope scope( &targets_[ owners[i] ]->arena_ ); built[i] = new Consensus( clusters[i], targets_[ owners[i] ] ); } );
+        pool.run( targets_.size(), [&]( int i ){ bridged[i] = targets_[i]->assemble( vector<Consensus*>( built.begin()+firsts[i], built.begin()+firsts[i+1] ) ); } );
+        for ( int i = 0; i < bridged.size(); i++ ) consensus.insert( consensus.end(), bridged[i].begin(), bridged[i].end() );
+        for ( int i = 0; i < bridged.size(); i++ ) tars.resize( tars.size() + bridged[i].size(), targets_[i] );
+        seqs.resize( consensus.size() );
     }
+    string ofn = getOutName( outPrefix );
     
     cout << "    " << to_string( reads_.size() ) << " reads were found to match the query sequence." << endl;
-    cout << "    " << to_string( consensus.size() ) << " consensus sequences were assembled!" << endl;
+    cout << "    " << to_string( seqs.size() ) << " consensus sequences were assembled!" << endl;
     cout << endl << "Writing results to: " << ofn << endl;
+    pool.run( consensus.size(), [&]( int i ){ Arena::Scope scope( &tars[i]->arena_ ); seqs[i] = consensus[i]->resolve(); } );
     ofstream ofs( ofn );
-    for ( int i = 0; i < consensus.size(); i++ )
+    for ( int i = 0; i < seqs.size(); i++ )
     {
-        string seq = consensus[i]->resolve();
         ofs << ">consensus_" + to_string( i+1 ) + "\n";
-        ofs << seq + "\n";
+        ofs << seqs[i] + "\n";
     }
     ofs.close();
 }
 
+void Result::stream( Target* tar, vector<MatchQuery*>& mqs, vector<QueryBinaries*>& qbs, vector<ReadId>& offsets, string& outPrefix, int threads, bool poa )
+{
+    // The search fills the queue in coordinate order while reads are aligned, so any cluster no later read can reach is written straight away
+    if ( !ofs_.is_open() ) ofs_.open( ofn_ = getOutName( outPrefix ) );
+    BoundedQueue< pair<int, Read> > queue( queueSize_ );
+    vector< BoundedQueue< pair<int, Read> >* > shards;
+    vector<thread> searches;
+    if ( mqs.size() == 1 ) searches.push_back( thread( [&](){ mqs[0]->yield( qbs[0], queue ); } ) );
+    else for ( int i = 0; i < mqs.size(); i++ ) shards.push_back( new BoundedQueue< pair<int, Read> >( queueSize_ ) );
+    for ( int i = 0; i < shards.size(); i++ ) searches.push_back( thread( [&, i](){ mqs[i]->yield( qbs[i], *shards[i] ); } ) );
+    if ( !shards.empty() ) searches.push_back( thread( [&](){ merge( shards, offsets, queue ); } ) );
+    ThreadPool pool( threads );
+    vector< pair<int, Read> > batch;
+    vector<MappedRead*> reads;
+    vector<Match*> matches;
+    while ( queue.pop( batch, batchSize_ ) )
+    {
+        reads.resize( batch.size() );
+        matches.resize( batch.size() );
+        pool.run( batch.size(), [&]( int i ){
+            reads[i] = new MappedRead( batch[i].second.id_, move( batch[i].second.seq_ ), batch[i].second.count_ );
+            matches[i] = tar->align( reads[i], batch[i].second.coords_[0], mqs[ getShard( offsets, batch[i].second.id_ ) ]->errors_[1] );
+        } );
+        for ( int i = 0; i < batch.size(); i++ ) if ( matches[i] ) tar->addMatch( matches[i] );
+        for ( int i = 0; i < batch.size(); i++ ) if ( !matches[i] ) delete reads[i];
+        streamed_ += batch.size();
+        
+        // Later reads start no earlier than the last key, and are aligned in a window reaching back up to a read length before that
+        vector<string> seqs = tar->stream( batch.back().first - params.readLen, pool, poa, false );
+        write( seqs );
+    }
+    for ( thread& search : searches ) search.join();
+    for ( BoundedQueue< pair<int, Read> >* shard : shards ) delete shard;
+    vector<string> seqs = tar->stream( 0, pool, poa, true );
+    write( seqs );
+}
+
+int Result::getShard( vector<ReadId>& offsets, ReadId id )
+{
+    return upper_bound( offsets.begin(), offsets.end(), id ) - offsets.begin() - 1;
+}
+
+void Result::merge( vector< BoundedQueue< pair<int, Read> >* >& shards, vector<ReadId>& offsets, BoundedQueue< pair<int, Read> >& queue )
+{
+    // Each shard yields in coordinate order, so always taking the lowest head keeps the merged stream in coordinate order too
+    vector< vector< pair<int, Read> > > heads( shards.size() );
+    vector<int> next( shards.size(), 0 );
+    for ( int i = 0; i < shards.size(); i++ ) shards[i]->pop( heads[i], batchSize_ );
+    for ( ;; )
+    {
+        int best = -1;
+        for ( int i = 0; i < shards.size(); i++ ) if ( next[i] < heads[i].size() && ( best < 0 || heads[i][ next[i] ].first < heads[best][ next[best] ].first ) ) best = i;
+        if ( best < 0 ) break;
+        pair<int, Read>& item = heads[best][ next[best]++ ];
+        item.second.id_ += offsets[best];
+        queue.push( move( item ) );
+        if ( next[best] == heads[best].size() && shards[best]->pop( heads[best], batchSize_ ) ) next[best] = 0;
+    }
+    queue.close();
+}
+
+void Result::finishStream()
+{
+    cout << "    " << to_string( streamed_ ) << " reads were found to match the query sequence." << endl;
+    cout << "    " << to_string( written_ ) << " consensus sequences were assembled!" << endl;
+    cout << endl << "Results written to: " << ofn_ << endl;
+    ofs_.close();
+}
+
+void Result::write( vector<string>& seqs )
+{
+    for ( string& seq : seqs ) ofs_ << ">consensus_" + to_string( ++written_ ) + "\n" + seq + "\n";
+}
+
 void Result::outputFullAlign( string& outPrefix )
 {
     for ( int i = 0; i < targets_.size(); i++ )
@@ -24,18 +24,31 @@
 #include "types.h"
 #include "target.h"
 #include "read.h"
+#include "match_query.h"
+#include <fstream>
 
 class Result
 {
-    MappedRead* addRead( ReadId id, string seq );
+    MappedRead* addRead( ReadId id, string seq, uint32_t count );
+    static string getOutName( string& outPrefix );
+    void write( vector<string>& seqs );
+    static void merge( vector< BoundedQueue< pair<int, Read> >* >& shards, vector<ReadId>& offsets, BoundedQueue< pair<int, Read> >& queue );
     
     vector<Target*> targets_;
     unordered_map<ReadId, MappedRead*> reads_;
+    ofstream ofs_;
+    string ofn_;
+    int streamed_, written_;
+    static const int queueSize_ = 4096, batchSize_ = 256;
 public:
+    Result(): streamed_( 0 ), written_( 0 ){};
     ~Result();
     Target* addTarget( string header, string seq );
-    void addMatch( Target* tar, ReadId id, string seq, int coord );
-    void assemble( string& outPrefix );
+    void addMatch( Target* tar, Read& r, int errors );
+    void assemble( string& outPrefix, int threads, bool poa );
+    void stream( Target* tar, vector<MatchQuery*>& mqs, vector<QueryBinaries*>& qbs, vector<ReadId>& offsets, string& outPrefix, int threads, bool poa );
+    static int getShard( vector<ReadId>& offsets, ReadId id );
+    void finishStream();
     void outputFullAlign( string& outPrefix );
 };
 
@@ -19,34 +19,104 @@
  */
 
 #include "target.h"
-#include "local_alignment.h"
 #include "consensus.h"
 #include "alignment.h"
+#include "shared_functions.h"
+#include "edit_distance.h"
+#include "poa_graph.h"
 #include <algorithm>
 #include <cassert>
+#include <climits>
 #include <fstream>
 
-bool Target::addMatch( MappedRead* read, int coord )
+bool Target::addMatch( MappedRead* read, int coord, int errors )
 {
+    Arena::Scope scope( &arena_ );
+    Match* match = align( read, coord, errors );
+    if ( match ) matches_.push_back( match );
+    return match;
+}
+
+void Target::addMatch( Match* match )
+{
+    matches_.push_back( match );
+}
+
+Match* Target::align( MappedRead* read, int coord, int errors )
+{
+    Match* match;
     int readLen = read->seq_.length();
     int startCoord = max( 0, coord-readLen );
     int cutLen = coord-startCoord + ( 2*readLen );
-    string t = seq_.substr( startCoord, cutLen ), align[2];
-    LocalAlignment la( t, read->seq_, true, false );
-    la.realign( align[0], align[1], false );
-    Alignment al( seq_, read->seq_, startCoord, cutLen, 0, read->seq_.size() );
-    AlignResult ar = al.align( 1, 4, 4, 4, false, false );
-    if ( ar.len_ < 15 ) assert( false );
-    if ( ar.len_ < 15 ) return false;
-    matches_.push_back( new Match( this, read, ar, startCoord ) );
-    
-    return true;
-//    vector<pair<int,int>> anchors = LocalAlignment::degapByAnchoring( align[0], align[1], true );
-//    if ( anchors.empty() ) assert( false );
-//    if ( anchors.empty() ) return false;
-//    matches_.push_back( new Match( this, read, align[0], align[1], anchors, startCoord ) );
-//    
-//    return true;
+    if ( coord >= 0 && coord+readLen <= seq_.size() && ( match = getUngapped( read, coord, readLen / 10 ) ) ) return match;
+    int band = ( readLen * errors ) / 100 + 8;
+    Alignment ba( seq_, read->seq_, startCoord, cutLen, 0, readLen );
+    ba.setBand( coord-startCoord, band );
+    AlignResult ar = ba.align( 1, 4, 4, 4, false, false );
+    int overhang = max( 0, -coord ) + max( 0, coord+readLen-(int)seq_.size() );
+    if ( ar.len_ < min( readLen, 15 ) || ar.lIgnore[1] + ar.rIgnore[1] - overhang > readLen / 2 )
+    {
+        // Only realign the full window if the read could plausibly fit somewhere within it
+        if ( EditDistance::isWithin( seq_, startCoord, cutLen, read->seq_, overhang + ( readLen * errors ) / 100 + 2 ) )
+        {
+            Alignment al( seq_, read->seq_, startCoord, cutLen, 0, read->seq_.size() );
+            ar = al.align( 1, 4, 4, 4, false, false );
+        }
+    }
+    if ( ar.len_ < 15 ) return NULL;
+    return new Match( this, read, ar, startCoord );
+}
+
+Match* Target::getUngapped( MappedRead* read, int coord, int limit )
+{
+    // Score the hit diagonal as Alignment would with free ends; a few scattered mismatches never justify a gap
+    vector<int> misses = getMismatches( seq_, coord, read->seq_, limit );
+    if ( misses.size() > limit ) return NULL;
+    misses.push_back( read->seq_.size() );
+    int score = 0, best = 0, start = 0, anchors[2]{ 0, -1 };
+    for ( int i = 0; i < misses.size(); i++ )
+    {
+        score += misses[i] - ( i ? misses[i-1]+1 : 0 );
+        if ( score > best ){ best = score; anchors[0] = start; anchors[1] = misses[i]-1; }
+        if ( score < 4 ) start = misses[i]+1;
+        score = max( 0, score-4 );
+    }
+    if ( anchors[1]-anchors[0] < 14 ) return NULL;
+    return new Match( this, read, anchors, best, coord );
+}
+
+vector<vector<Match*>> Target::getClusters()
+{
+    sortMatches();
+    vector<vector<Match*>> clusters;
+    for ( int i = 0; i < matches_.size(); i++ )
+    {
+        int anchors[2]{ matches_[i]->getAnchor( 0 ), matches_[i]->getAnchor( 1 ) };
+        vector<Match*> overlapping{ matches_[i] };
+        for ( ; i+1 < matches_.size() && matches_[i+1]->getAnchor( 0 ) < anchors[1]; i++ )
+        {
+            anchors[1] = max( anchors[1], matches_[i+1]->getAnchor( 1 ) );
+            overlapping.push_back( matches_[i+1] );
+        }
+        clusters.push_back( overlapping );
+    }
+    return clusters;
+}
+
+vector<vector<Match*>> Target::getClusters( int limit )
+{
+    // A match starting at or after limit can only join clusters that reach past it, and only by way of every cluster sorted after them
+    vector<vector<Match*>> clusters = getClusters();
+    int closed = 0, used = 0;
+    for ( ; closed < clusters.size(); used += clusters[closed++].size() )
+    {
+        int end = clusters[closed][0]->getAnchor( 1 );
+        for ( Match* m : clusters[closed] ) end = max( end, m->getAnchor( 1 ) );
+        if ( end > limit ) break;
+    }
+    clusters.resize( closed );
+    matches_.erase( matches_.begin(), matches_.begin() + used );
+    return clusters;
 }
 
 vector<pair<int, int>> Target::getGaps()
@@ -62,28 +132,24 @@ vector<pair<int, int>> Target::getGaps()
     return gaps;
 }
 
+void Target::release( vector<Match*>& matches )
+{
+    // Streamed reads are only ever placed once, so each match owns its read
+    for ( Match* m : matches ) delete m->read_;
+    for ( Match* m : matches ) delete m;
+}
+
 void Target::sortMatches()
 {
     sort( matches_.begin(), matches_.end(), []( Match* a, Match* b ){
-        return !a->coords_.empty() && !b->coords_.empty() ? a->coords_[0] < b->coords_[0] : a->coords_.empty() && !b->coords_.empty();
+        if ( a->coords_.empty() || b->coords_.empty() ) return a->coords_.empty() && !b->coords_.empty();
+        return a->coords_[0] == b->coords_[0] ? a->read_->id_ < b->read_->id_ : a->coords_[0] < b->coords_[0];
     });
 }
 
-vector<Consensus*> Target::assemble()
+vector<Consensus*> Target::assemble( vector<Consensus*> consensus )
 {
-    sortMatches();
-    vector<Consensus*> consensus;
-    for ( int i = 0; i < matches_.size(); i++ )
-    {
-        int anchors[2]{ matches_[i]->getAnchor( 0 ), matches_[i]->getAnchor( 1 ) };
-        vector<Match*> overlapping{ matches_[i] };
-        for ( ; i+1 < matches_.size() && matches_[i+1]->getAnchor( 0 ) < anchors[1]; i++ )
-        {
-            anchors[1] = max( anchors[1], matches_[i+1]->getAnchor( 1 ) );
-            overlapping.push_back( matches_[i+1] );
-        }
-        consensus.push_back( new Consensus( overlapping, this ) );
-    }
+    Arena::Scope scope( &arena_ );
     Consensus::reSort( consensus );
     for ( int i = 0; i+1 < consensus.size(); i++ ) if ( Consensus::bridge( consensus[i], consensus[i+1] ) )
     {
@@ -93,6 +159,54 @@ vector<Consensus*> Target::assemble()
     return consensus;
 }
 
+string Target::assemblePoa( vector<Match*>& cluster )
+{
+    // The graph starts as the query between the cluster's outermost anchors and reads are soft-clipped to it, so unlike the
+    // default engine the consensus never extends past that span
+    int coords[2]{ cluster[0]->getAnchor( 0 ), cluster[0]->getAnchor( 1 ) };
+    for ( Match* m : cluster ) coords[0] = min( coords[0], m->getAnchor( 0 ) );
+    for ( Match* m : cluster ) coords[1] = max( coords[1], m->getAnchor( 1 ) );
+    PoaGraph graph( seq_, coords[0], coords[1] );
+    for ( Match* m : cluster ) graph.addMatch( m );
+    return graph.getConsensus();
+}
+
+vector<string> Target::stream( int limit, ThreadPool& pool, bool poa, bool last )
+{
+    vector<vector<Match*>> clusters = getClusters( last ? INT_MAX : limit );
+    vector<string> seqs( poa ? clusters.size() : 0 );
+    if ( poa ) pool.run( clusters.size(), [&]( int i ){ seqs[i] = assemblePoa( clusters[i] ); } );
+    if ( poa ) for ( vector<Match*>& c : clusters ) release( c );
+    if ( poa ) return seqs;
+    
+    // Each cluster is built in its own arena so that it can be freed as soon as the consensus it ends up in is written
+    vector<Arena*> arenas( clusters.size() );
+    vector<Consensus*> built( clusters.size() );
+    vector<StreamGroup> done;
+    for ( Arena*& arena : arenas ) arena = new Arena();
+    pool.run( clusters.size(), [&]( int i ){ Arena::Scope scope( arenas[i] ); built[i] = new Consensus( clusters[i], this ); } );
+    for ( int i = 0; i < built.size(); i++ )
+    {
+        Arena::Scope scope( open_.cons_ ? open_.arenas_.back() : arenas[i] );
+        if ( open_.cons_ && Consensus::bridge( open_.cons_, built[i] ) ) delete built[i];
+        else
+        {
+            if ( open_.cons_ ) done.push_back( open_ );
+            open_ = StreamGroup( built[i] );
+        }
+        open_.arenas_.push_back( arenas[i] );
+        open_.matches_.insert( open_.matches_.end(), clusters[i].begin(), clusters[i].end() );
+    }
+    if ( last && open_.cons_ ) done.push_back( open_ );
+    if ( last ) open_ = StreamGroup( NULL );
+    
+    seqs.resize( done.size() );
+    pool.run( done.size(), [&]( int i ){ Arena::Scope scope( done[i].arenas_.back() ); seqs[i] = done[i].cons_->resolve(); } );
+    for ( StreamGroup& g : done ) for ( Arena* arena : g.arenas_ ) delete arena;
+    for ( StreamGroup& g : done ) release( g.matches_ );
+    return seqs;
+}
+
 void Target::print( ofstream& ofs )
 {
     sortMatches();
@@ -25,19 +25,40 @@
 #include "match.h"
 #include "read.h"
 #include "consensus.h"
+#include "arena.h"
+#include "thread_pool.h"
+
+// A streamed consensus that later clusters may still be bridged onto, with the arenas and matches it was built from
+struct StreamGroup
+{
+    StreamGroup( Consensus* cons ): cons_( cons ){};
+    Consensus* cons_;
+    vector<Arena*> arenas_;
+    vector<Match*> matches_;
+};
 
 class Target
 {
     vector<Match*> matches_;
+    StreamGroup open_;
     
+    Match* getUngapped( MappedRead* read, int coord, int limit );
     vector<pair<int,int>> getGaps();
+    static void release( vector<Match*>& matches );
     void sortMatches();
 public:
-    Target( string header, string seq ): header_( header ), seq_( seq ){};
-    bool addMatch( MappedRead* read, int coord );
-    vector<Consensus*> assemble();
+    Target( string header, string seq ): open_( NULL ), seq_( seq ), header_( header ){};
+    bool addMatch( MappedRead* read, int coord, int errors );
+    void addMatch( Match* match );
+    Match* align( MappedRead* read, int coord, int errors );
+    vector<Consensus*> assemble( vector<Consensus*> consensus );
+    string assemblePoa( vector<Match*>& cluster );
+    vector<vector<Match*>> getClusters();
+    vector<vector<Match*>> getClusters( int limit );
+    vector<string> stream( int limit, ThreadPool& pool, bool poa, bool last );
     void print( ofstream& ofs );
     string seq_, header_;
+    Arena arena_;
 };
 
 #endif /* GLIN_TARGET_H */
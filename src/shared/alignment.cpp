@@ -23,9 +23,24 @@
 #include <algorithm>
 #include <fstream>
 #include <cassert>
+#include <cmath>
+#include <climits>
+
+const uint64_t Alignment::checkpointCells_ = 1 << 24;
+
+Alignment::Alignment( SeqView a, SeqView b )
+: a_( a ), b_( b ), step_( 0 ), block_( -1 ), diag_( 0 ), band_( -1 ), scored_( false ), striped_( false )
+{
+    freeEnds_[0] = freeEnds_[1] = false;
+    gapExt_ = 1;
+    gapOpen_ = 2;
+    hit_ = 1;
+    miss_ = 1;
+    iMax_ = jMax_ = 0;
+}
 
 Alignment::Alignment( string& a, string& b, int aStart, int aLen, int bStart, int bLen )
-: a_( a.substr( aStart, aLen ) ), b_( b.substr( bStart, bLen ) ), m_( aLen+1, vector<int>( bLen+1 ) ), p_( aLen+1, vector<int>( bLen+1 ) ), scored_( false )
+: a_( a, aStart, aLen ), b_( b, bStart, bLen ), step_( 0 ), block_( -1 ), diag_( 0 ), band_( -1 ), scored_( false ), striped_( false )
 {
     freeEnds_[0] = freeEnds_[1] = false;
     gapExt_ = 1;
@@ -44,7 +59,7 @@ void Alignment::debug()
     for ( int j = 0; j <= b_.size(); j++ )
     {
         line = j ? string( 1, b_[j-1] ) : "-";
-        for ( int i = 0; i <= a_.size(); i++ ) line += "," + to_string( p_[i][j] );
+        for ( int i = 0; i <= a_.size(); i++ ) line += "," + to_string( getGap( i, j ) );
         ofs << line << "\n";
     }
     line = "";
@@ -55,7 +70,7 @@ void Alignment::debug()
     for ( int j = 0; j <= b_.size(); j++ )
     {
         line = j ? string( 1, b_[j-1] ) : "-";
-        for ( int i = 0; i <= a_.size(); i++ ) line += "," + to_string( m_[i][j] );
+        for ( int i = 0; i <= a_.size(); i++ ) line += "," + to_string( getScore( i, j ) );
         ofs << line << "\n";
     }
     ofs.close();
@@ -64,58 +79,189 @@ void Alignment::debug()
 
 bool Alignment::isFreeStart( int i, int j )
 {
-    if ( p_[i][j] != 0 || m_[i][j] != 0 ) return false;
-    if ( i && j && m_[i][j] == miss_ ) return false;
+    if ( getGap( i, j ) != 0 || getScore( i, j ) != 0 ) return false;
+    if ( i && j && getScore( i, j ) == miss_ ) return false;
     return true;
 }
 
+int Alignment::getGap( int i, int j )
+{
+    if ( band_ >= 0 && ( !i || !j ) ) return i ? -i : j;
+    if ( band_ >= 0 ) return abs( i-j-diag_ ) <= band_ ? p_[ i*( 2*band_+2 ) + j-i+diag_+band_+1 ] : 0;
+    if ( step_ ) loadBlock( i );
+    if ( !striped_ ) return p_[ ( i-block_*step_ )*( b_.size()+1 ) + j ];
+    if ( !i || !j ) return i ? -i : j;
+    int kind = t_[ getIndex( i, j ) ];
+    if ( !kind ) return 0;
+    
+    // Recover the gap origin the scalar trackers would have held: the latest ungapped cell maximising score + coord * gapExt
+    int len = kind == 1 ? j-1 : i-1, best = 0, bestScore = ( kind == 1 ? getScore( i, 1 ) : getScore( 1, j ) );
+    for ( int k = 1; k < len; k++ )
+    {
+        int x = kind == 1 ? i : k+1, y = kind == 1 ? k+1 : j;
+        if ( !t_[ getIndex( x, y ) ] && getScore( x, y ) + k * gapExt_ >= bestScore + best * gapExt_ )
+        {
+            best = k;
+            bestScore = getScore( x, y );
+        }
+    }
+    return kind == 1 ? len-best : best-len;
+}
+
+int Alignment::getIndex( int i, int j )
+{
+    int segs = stripe_ / lanes_;
+    return ( i-1 )*stripe_ + ( ( j-1 ) % segs ) * lanes_ + ( j-1 ) / segs;
+}
+
+int Alignment::getScore( int i, int j )
+{
+    if ( band_ >= 0 && ( !i || !j ) ) return 0;
+    if ( band_ >= 0 ) return abs( i-j-diag_ ) <= band_ ? m_[ i*( 2*band_+2 ) + j-i+diag_+band_+1 ] : INT_MIN / 4;
+    if ( step_ ) loadBlock( i );
+    if ( !striped_ ) return m_[ ( i-block_*step_ )*( b_.size()+1 ) + j ];
+    if ( !i || !j ) return freeEnds_[0] || !( i+j ) ? 0 : -gapOpen_ - ( ( i+j ) * gapExt_ );
+    return h_[ getIndex( i, j ) ];
+}
+
+void Alignment::loadBlock( int i )
+{
+    if ( block_ >= 0 && i >= block_*step_ && i <= ( block_+1 )*step_ ) return;
+    
+    // Rescore the rows following the nearest checkpoint above row i, so that rows i and i-1 are both held
+    int w = b_.size()+1, mark = 2*w + 2*b_.size();
+    block_ = max( 0, i-1 ) / step_;
+    int* cp = &marks_[ block_*mark ], rows = min( step_, (int)a_.size()-block_*step_ );
+    vector<int> iMax( cp+2*w, cp+2*w+b_.size() ), iRef( cp+2*w+b_.size(), cp+mark );
+    copy( cp, cp+w, &m_[0] );
+    copy( cp+w, cp+2*w, &p_[0] );
+    for ( int k = 0; k < rows; k++ ) scoreRow( block_*step_+k, &m_[k*w], &m_[( k+1 )*w], &p_[( k+1 )*w], iMax.data(), iRef.data(), NULL );
+}
+
 void Alignment::score()
 {
-    for ( int i = 0; i < a_.size()+1; i++ ) p_[i][0] = -i;
-    for ( int j = 0; j < b_.size()+1; j++ ) p_[0][j] = j;
-    for ( int i = 0; i < a_.size()+1; i++ ) m_[i][0] = freeEnds_[0] || !i ? 0 : -gapOpen_ - ( i * gapExt_ );
-    for ( int j = 0; j < b_.size()+1; j++ ) m_[0][j] = freeEnds_[0] || !j ? 0 : -gapOpen_ - ( j * gapExt_ );
-    vector<int> iMax( b_.size(), 0 ), jMax( a_.size(), 0 );
-    for ( int i = 0; i < a_.size(); i++ )
+    // The striped kernel is exact while every reachable score fits comfortably within 16 bits
+    int limit = ( a_.size() + b_.size() + 2 ) * ( max( hit_, miss_ ) + gapExt_ ) + gapOpen_;
+    step_ = 0;
+    if ( band_ >= 0 ) scoreBanded();
+    else if ( lanes_ > 1 && limit < 15000 && !a_.empty() && !b_.empty() ) scoreStriped();
+    else if ( uint64_t( a_.size()+1 ) * ( b_.size()+1 ) > checkpointCells_ ) scoreCheckpointed();
+    else scoreScalar();
+}
+
+void Alignment::scoreBanded()
+{
+    // Row i holds only the cells within band_ of the diagonal i-j == diag_, with column j at j-i+diag_+band_+1 and its left border where in reach
+    assert( freeEnds_[0] && freeEnds_[1] );
+    int w = 2*band_+2, best = 0;
+    striped_ = false;
+    m_.assign( ( a_.size()+1 ) * w, 0 );
+    p_.assign( ( a_.size()+1 ) * w, 0 );
+    for ( int j = max( 0, -diag_-band_-1 ); j <= min( b_.size(), band_-diag_ ); j++ ) p_[ j+diag_+band_+1 ] = j;
+    vector<int> iMax( b_.size(), 0 ), iRef( b_.size(), 0 );
+    iMax_ = jMax_ = 0;
+    for ( int i = 0; i < a_.size(); i++ ) scoreRow( i, &m_[i*w], &m_[( i+1 )*w], &p_[( i+1 )*w], iMax.data(), iRef.data(), &best );
+    scored_ = true;
+}
+
+void Alignment::scoreCheckpointed()
+{
+    // Keep only every step_'th row along with the gap trackers; traceback rescores one block of rows at a time
+    int w = b_.size()+1, mark = 2*w + 2*b_.size(), best = 0;
+    striped_ = false;
+    step_ = max( 1, (int)sqrt( a_.size() ) );
+    block_ = -1;
+    marks_.assign( ( a_.size() / step_ + 1 ) * mark, 0 );
+    m_.assign( ( step_+1 ) * w, 0 );
+    p_.assign( ( step_+1 ) * w, 0 );
+    for ( int j = 0; j < w; j++ ) m_[j] = freeEnds_[0] || !j ? 0 : -gapOpen_ - ( j * gapExt_ );
+    for ( int j = 0; j < w; j++ ) p_[j] = j;
+    vector<int> iMax( b_.size(), 0 ), iRef( b_.size(), 0 );
+    iMax_ = jMax_ = 0;
+    for ( int i = 0; i <= a_.size(); i++ )
     {
-        for ( int j = 0; j < b_.size(); j++ )
+        int* prev = &m_[ ( i%2 )*w ],* m = &m_[ ( ( i+1 )%2 )*w ],* p = &p_[ ( ( i+1 )%2 )*w ];
+        if ( !( i % step_ ) )
         {
-            m_[i+1][j+1] = m_[i][j] + ( a_[i] == b_[j] ? hit_ : -miss_ );
-            p_[i+1][j+1] = 0;
-            
-            // Find the previous i value for which the current j was highest
-            int aGapLen = j-jMax[i];
-            int bGapLen = i-iMax[j];
-            int aGapScore = m_[i+1][jMax[i]+1] - gapOpen_ - ( aGapLen * gapExt_ );
-            int bGapScore = m_[iMax[j]+1][j+1] - gapOpen_ - ( bGapLen * gapExt_ );
-            if ( aGapScore > m_[i+1][j+1] )
-            {
-                m_[i+1][j+1] = aGapScore;
-                p_[i+1][j+1] = aGapLen;
-            }
-            if ( bGapScore > m_[i+1][j+1] )
-            {
-                m_[i+1][j+1] = bGapScore;
-                p_[i+1][j+1] = -bGapLen;
-            }
-            if ( freeEnds_[0] && m_[i+1][j+1] < 0 )
+            int* cp = &marks_[ ( i / step_ )*mark ];
+            copy( prev, prev+w, cp );
+            copy( &p_[ ( i%2 )*w ], &p_[ ( i%2 )*w ]+w, cp+w );
+            copy( iMax.begin(), iMax.end(), cp+2*w );
+            copy( iRef.begin(), iRef.end(), cp+2*w+b_.size() );
+        }
+        if ( i < a_.size() ) scoreRow( i, prev, m, p, iMax.data(), iRef.data(), &best );
+    }
+    scored_ = true;
+}
+
+void Alignment::scoreRow( int i, int* prev, int* m, int* p, int* iMax, int* iRef, int* best )
+{
+    // Scores row i+1 from row i; iRef holds the score at each column's gap origin, as that row may no longer be held
+    // A banded row i holds column j at j-o[0] and row i+1 at j-o[1], and only columns within the band are scored
+    int lo = 0, hi = b_.size(), o[2]{ 0, 0 };
+    if ( band_ >= 0 )
+    {
+        lo = max( 0, i-diag_-band_ );
+        hi = min( hi, i-diag_+band_+1 );
+        o[0] = i-diag_-band_-1;
+        o[1] = o[0]+1;
+    }
+    int jMax = lo;
+    if ( band_ < 0 || ( o[1] <= 0 && o[1] > -2*band_-2 ) ) m[-o[1]] = freeEnds_[0] ? 0 : -gapOpen_ - ( ( i+1 ) * gapExt_ );
+    if ( band_ < 0 || ( o[1] <= 0 && o[1] > -2*band_-2 ) ) p[-o[1]] = -( i+1 );
+    for ( int j = lo; j < hi; j++ )
+    {
+        int s = prev[ j-o[0] ] + ( a_[i] == b_[j] ? hit_ : -miss_ ), gap = 0;
+        
+        // Find the previous i value for which the current j was highest
+        int aGapLen = j-jMax;
+        int bGapLen = i-iMax[j];
+        int aGapScore = ( aGapLen ? m[ jMax+1-o[1] ] : s ) - gapOpen_ - ( aGapLen * gapExt_ );
+        int bGapScore = ( bGapLen ? iRef[j] : s ) - gapOpen_ - ( bGapLen * gapExt_ );
+        if ( aGapScore > s )
+        {
+            s = aGapScore;
+            gap = aGapLen;
+        }
+        if ( bGapScore > s )
+        {
+            s = bGapScore;
+            gap = -bGapLen;
+        }
+        if ( freeEnds_[0] && s < 0 ) s = gap = 0;
+        m[ j+1-o[1] ] = s;
+        p[ j+1-o[1] ] = gap;
+        if ( !i ) iRef[j] = s;
+        
+        if ( gap == 0 )
+        {
+            if ( !aGapLen || s >= m[ jMax+1-o[1] ] - ( aGapLen * gapExt_ ) ) jMax = j;
+            if ( !bGapLen || s >= iRef[j] - ( bGapLen * gapExt_ ) )
             {
-                m_[i+1][j+1] = 0;
-                p_[i+1][j+1] = 0;
+                iMax[j] = i;
+                iRef[j] = s;
             }
-            
-            if ( p_[i+1][j+1] == 0 )
+            if ( best && s > *best )
             {
-                if ( m_[i+1][j+1] >= m_[i+1][jMax[i]+1] - ( aGapLen * gapExt_ ) ) jMax[i] = j;
-                if ( m_[i+1][j+1] >= m_[iMax[j]+1][j+1] - ( bGapLen * gapExt_ ) ) iMax[j] = i;
-                if ( m_[i+1][j+1] > m_[iMax_][jMax_])
-                {
-                    iMax_ = i+1;
-                    jMax_ = j+1;
-                }
+                iMax_ = i+1;
+                jMax_ = j+1;
+                *best = s;
             }
         }
     }
+}
+
+void Alignment::scoreScalar()
+{
+    int w = b_.size()+1, best = 0;
+    striped_ = false;
+    m_.assign( ( a_.size()+1 ) * w, 0 );
+    p_.assign( ( a_.size()+1 ) * w, 0 );
+    for ( int j = 0; j < w; j++ ) m_[j] = freeEnds_[0] || !j ? 0 : -gapOpen_ - ( j * gapExt_ );
+    for ( int j = 0; j < w; j++ ) p_[j] = j;
+    vector<int> iMax( b_.size(), 0 ), iRef( b_.size(), 0 );
+    iMax_ = jMax_ = 0;
+    for ( int i = 0; i < a_.size(); i++ ) scoreRow( i, &m_[i*w], &m_[( i+1 )*w], &p_[( i+1 )*w], iMax.data(), iRef.data(), &best );
     scored_ = true;
 }
 
@@ -157,7 +303,8 @@ AlignResult Alignment::align( bool lAnchored, bool rAnchored )
     while ( i > 0 || j > 0 )
     {
         assert( i >= 0 && j >= 0 );
-        if ( !i || !j || ( freeEnds_[0] && p_[i][j] == 0 && m_[i][j] == 0 && !( i && j && m_[i-1][j-1] == miss_ ) ) )
+        int gap = i && j ? getGap( i, j ) : 0;
+        if ( !i || !j || ( freeEnds_[0] && gap == 0 && getScore( i, j ) == 0 && getScore( i-1, j-1 ) != miss_ ) )
         {
             if ( freeEnds_[0] ) result.lIgnore[0] = i;
             if ( freeEnds_[0] ) result.lIgnore[1] = j;
@@ -168,14 +315,14 @@ AlignResult Alignment::align( bool lAnchored, bool rAnchored )
             if ( s[1].size() > s[0].size() ) s[0] += string( s[1].size()-s[0].size(), '-');
             if ( freeEnds_[0] ) start = s[0].size() - start;
         }
-        else if ( p_[i][j] == 0 )
+        else if ( gap == 0 )
         {
             s[0] += a_[--i];
             s[1] += b_[--j];
         }
-        else if ( p_[i][j] < 0 )
+        else if ( gap < 0 )
         {
-            for ( int k = p_[i][j]; k++ < 0; )
+            for ( int k = gap; k++ < 0; )
             {
                 s[0] += a_[--i];
                 s[1] += '-';
@@ -183,7 +330,7 @@ AlignResult Alignment::align( bool lAnchored, bool rAnchored )
         }
         else
         {
-            for ( int k = p_[i][j]; k-- > 0; )
+            for ( int k = gap; k-- > 0; )
             {
                 s[0] += '-';
                 s[1] += b_[--j];
@@ -199,12 +346,20 @@ AlignResult Alignment::align( bool lAnchored, bool rAnchored )
     result.s_[1] = string( s[1].rbegin(), s[1].rend() );
     result.start_ = start;
     result.len_ = s[0].size() - len - start;
-    result.score_ = freeEnds_[1] ? m_[iMax_][jMax_] : m_[a_.size()][b_.size()];
+    result.score_ = freeEnds_[1] ? getScore( iMax_, jMax_ ) : getScore( a_.size(), b_.size() );
     
 //    return make_pair( start, len );
     return result;
 }
 
+void Alignment::setBand( int diag, int band )
+{
+    // Restricts scoring to within band of the diagonal along which a[i+diag] pairs with b[i]; only free-ended alignments may be banded
+    diag_ = diag;
+    band_ = band;
+    scored_ = false;
+}
+
 AlignResult Alignment::alignBySeed( string& a, string& b, int aStart, int bStart, int len )
 {
     Alignment l( a, b, 0, aStart, 0, bStart );
@@ -277,8 +432,9 @@ int SnpAlignment::BubbleAlign::getDelLen()
 
 
 SnpAlignment::SnpAlignment( string& a, string& b, int aStart, int aLen, int bStart, int bLen, vector<SNPs*> snps, vector<Bubble*>& bubbles )
-: Alignment( a, b, aStart, aLen, bStart, bLen ), wrapper_( NULL ), s_( aLen+1, vector<AlignPointer>( bLen+1 ) ), snps_( snps ), parent_( NULL )
+: Alignment( a, b, aStart, aLen, bStart, bLen ), wrapper_( NULL ), snps_( snps ), parent_( NULL )
 {
+    s_.assign( ( a_.size()+1 ) * ( b_.size()+1 ), AlignPointer() );
     coord_[0] = aStart;
     coord_[1] = bStart;
     sort( snps_.begin(), snps_.end(), []( SNPs* a, SNPs* b ){ return a->start_+a->len_ < b->start_+b->len_; } );
@@ -295,8 +451,9 @@ SnpAlignment::SnpAlignment( string& a, string& b, int aStart, int aLen, int bSta
 }
 
 SnpAlignment::SnpAlignment( BubbleAlign* wrapper, string& a, int coord )
-: Alignment( a, wrapper->parent_->b_, 0, a.size(), 0, wrapper->parent_->b_.size() ), s_( a.size()+1, vector<AlignPointer>( wrapper->parent_->b_.size()+1 ) ), parent_( wrapper->parent_ )
+: Alignment( SeqView( a ), wrapper->parent_->b_ ), parent_( wrapper->parent_ )
 {
+    s_.assign( ( a_.size()+1 ) * ( b_.size()+1 ), AlignPointer() );
     coord_[0] = coord;
     coord_[1] = parent_->coord_[1];
     hit_ = parent_->hit_;
@@ -338,13 +495,13 @@ SnpAlignment::SnpAlignment( BubbleAlign* wrapper, string& a, int coord )
 void SnpAlignment::score()
 {
     vector<GapPointer> iMax( b_.size(), GapPointer() );
-    for ( int i = 0; i < a_.size()+1; i++ ) s_[i][0].set( this, 0, 0, freeEnds_[0] || !i ? 0 : -gapOpen_ - ( i * gapExt_ ) );
-    for ( int j = 0; j < b_.size()+1; j++ ) s_[0][j].set( this, 0, 0, freeEnds_[0] || !j ? 0 : -gapOpen_ - ( j * gapExt_ ) );
-    for ( int j = 0; j < iMax.size(); j++ ) iMax[j].set( this, 0, s_[0][j].score_ );
+    for ( int i = 0; i < a_.size()+1; i++ ) s( i, 0 ).set( this, 0, 0, freeEnds_[0] || !i ? 0 : -gapOpen_ - ( i * gapExt_ ) );
+    for ( int j = 0; j < b_.size()+1; j++ ) s( 0, j ).set( this, 0, 0, freeEnds_[0] || !j ? 0 : -gapOpen_ - ( j * gapExt_ ) );
+    for ( int j = 0; j < iMax.size(); j++ ) iMax[j].set( this, 0, s( 0, j ).score_ );
     if ( !freeEnds_[0] ) for ( BubbleAlign* ba : bubbles_ ) if ( ba->getDelLen() > 0 )
     {
         int len = ba->getDelLen();
-        for ( int i = ba->end_; i < a_.size()+1; i++ )  s_[i][0].update( this, 0, 0, i>len ? -gapOpen_ - ( ( i-len ) * gapExt_ ) : 0 );
+        for ( int i = ba->end_; i < a_.size()+1; i++ )  s( i, 0 ).update( this, 0, 0, i>len ? -gapOpen_ - ( ( i-len ) * gapExt_ ) : 0 );
     }
     score( iMax );
 }
@@ -369,21 +526,21 @@ void SnpAlignment::score( vector<GapPointer>& iMax )
         for ( int j = 0; j < b_.size(); j++ )
         {
             // Simple match
-            bool matched = s_[i+1][j+1].set( this, i, j, s_[i][j].score_ + ( a_[i] == b_[j] ? hit_ : -miss_ ) );
+            bool matched = s( i+1, j+1 ).set( this, i, j, s( i, j ).score_ + ( a_[i] == b_[j] ? hit_ : -miss_ ) );
             // Insert a_, gap b_
-            if ( s_[i+1][j+1].update( iMax[j].align_, iMax[j].i_, j+1, iMax[j].score( gapOpen_, gapExt_ ) ) ) matched = false;
+            if ( s( i+1, j+1 ).update( iMax[j].align_, iMax[j].i_, j+1, iMax[j].score( gapOpen_, gapExt_ ) ) ) matched = false;
             // Insert b_, gap a_
-            if ( s_[i+1][j+1].update( this, i+1, jMax[i]+1, s_[i+1][jMax[i]+1].score_ - gapOpen_ - ( ( j-jMax[i] ) * gapExt_ ) ) ) matched = false;
+            if ( s( i+1, j+1 ).update( this, i+1, jMax[i]+1, s( i+1, jMax[i]+1 ).score_ - gapOpen_ - ( ( j-jMax[i] ) * gapExt_ ) ) ) matched = false;
             // Try match bubbles or insert from bubble
             for ( BubbleAlign* ba : bubbles[1][i] ) getBubble( ba, iMax, i, j, matched );
             // Reset if free ends
-            if ( freeEnds_[0] && s_[i+1][j+1].score_ < 0 ) matched = s_[i+1][j+1].set( this, i+1, j+1, 0 );
+            if ( freeEnds_[0] && s( i+1, j+1 ).score_ < 0 ) matched = s( i+1, j+1 ).set( this, i+1, j+1, 0 );
             
             if ( matched )
             {
-                if ( s_[i+1][j+1].score_ >= s_[i+1][jMax[i]+1].score_ - ( ( j-jMax[i] ) * gapExt_ ) ) jMax[i] = j;
-                if ( s_[i+1][j+1].score_ >= iMax[j].score_ - ( ( iMax[j].len_-iMax[j].del_ ) * gapExt_ ) ) iMax[j].set( this, i+1, s_[i+1][j+1].score_ );
-                if ( s_[i+1][j+1].score_ >= s_[ijMax_.first][ijMax_.second].score_ ) ijMax_ = make_pair( i+1, j+1 );
+                if ( s( i+1, j+1 ).score_ >= s( i+1, jMax[i]+1 ).score_ - ( ( j-jMax[i] ) * gapExt_ ) ) jMax[i] = j;
+                if ( s( i+1, j+1 ).score_ >= iMax[j].score_ - ( ( iMax[j].len_-iMax[j].del_ ) * gapExt_ ) ) iMax[j].set( this, i+1, s( i+1, j+1 ).score_ );
+                if ( s( i+1, j+1 ).score_ >= s( ijMax_.first, ijMax_.second ).score_ ) ijMax_ = make_pair( i+1, j+1 );
             }
 //            for ( BubbleAlign* ba : dels ) if ( i == ba->end_ && i >= ba->snps_->len_ ) s_[i+1][j+1].update( this, i-ba->snps_->len_, j, s_[i-ba->snps_->len_][j].score_ + ( a_[i] == b_[j] ? hit_ : -miss_ ) );
         }
@@ -398,12 +555,12 @@ void SnpAlignment::setBubble( vector<BubbleAlign*>& prv, BubbleAlign* ba, vector
     {
         ba->align_->freeEnds_[0] = freeEnds_[0];
         ba->align_->freeEnds_[1] = freeEnds_[1];
-        for ( int i = 1; i < ba->align_->a_.size()+1; i++ ) ba->align_->s_[i][0].set( s_[ii][0].align_, 0, 0, freeEnds_[0] ? 0 : min( s_[ii][0].score_, -gapOpen_ ) - ( i * gapExt_ ) );
-        for ( int j = 0; j < ba->align_->b_.size()+1; j++ ) ba->align_->s_[0][j] = s_[ii][j];
+        for ( int i = 1; i < ba->align_->a_.size()+1; i++ ) ba->align_->s( i, 0 ).set( s( ii, 0 ).align_, 0, 0, freeEnds_[0] ? 0 : min( s( ii, 0 ).score_, -gapOpen_ ) - ( i * gapExt_ ) );
+        for ( int j = 0; j < ba->align_->b_.size()+1; j++ ) ba->align_->s( 0, j ) = s( ii, j );
         if ( !freeEnds_[0] ) for ( BubbleAlign* baba : ba->align_->bubbles_ ) if ( baba->getDelLen() > 0 )
         {
             int len = baba->getDelLen();
-            for ( int i = baba->end_; i < ba->align_->a_.size()+1; i++ )  ba->align_->s_[i][0].update( s_[ii][0].align_, 0, 0, ( s_[ii][0].score_ < 0 || i>len ) ? min( s_[ii][0].score_, -gapOpen_ ) - ( ( i-len ) * gapExt_ ) : 0 );
+            for ( int i = baba->end_; i < ba->align_->a_.size()+1; i++ )  ba->align_->s( i, 0 ).update( s( ii, 0 ).align_, 0, 0, ( s( ii, 0 ).score_ < 0 || i>len ) ? min( s( ii, 0 ).score_, -gapOpen_ ) - ( ( i-len ) * gapExt_ ) : 0 );
         }
 //        if ( a_ == "AAGGGATTGGTGGAGTTTCGTTTCGTCTCCATCAGCACCTTGTGAGAAATCATAAGTCTTTGGGTTCCGGGGGAGTATGG" && b_ == "TCAGGGTGGTCTGTCGATTTAACGATAGACCGAACTGTAGGAGAAATCAAAGTCTTTGGGTTCCGGGGGG" && ba->bubble_ && ba->bubble_->start_ == 1045 )
 ////        if ( false )
@@ -413,13 +570,13 @@ void SnpAlignment::setBubble( vector<BubbleAlign*>& prv, BubbleAlign* ba, vector
             {
                 if ( baba->align_ )
                 {
-                    int iii = baba->align_->s_.size()-1;
-                    ba->align_->s_[0][j].update( baba->align_, iii, j, baba->align_->s_[iii][j].score_ );
+                    int iii = baba->align_->a_.size();
+                    ba->align_->s( 0, j ).update( baba->align_, iii, j, baba->align_->s( iii, j ).score_ );
                 }
                 else
                 {
                     int iii = baba->start_;
-                    if ( ba->align_->s_[0][j].update( s_[iii][j].align_, s_[iii][j].i_, s_[iii][j].j_, s_[iii][j].score_ ) ) ba->align_->s_[0][j].deletion_ = true;
+                    if ( ba->align_->s( 0, j ).update( s( iii, j ).align_, s( iii, j ).i_, s( iii, j ).j_, s( iii, j ).score_ ) ) ba->align_->s( 0, j ).deletion_ = true;
                 }
             }
 //        }
@@ -442,16 +599,16 @@ void SnpAlignment::getBubble( BubbleAlign* ba, vector<GapPointer>& iMax, int i,
     {
         int ii = ba->align_->a_.size();
         // Try continue from the last a_ of bubble
-        if ( s_[i+1][j+1].update( ba->align_, ii, j, ba->align_->s_[ii][j].score_ + ( a_[i] == b_[j] ? hit_ : -miss_ ) ) ) matched = true;
+        if ( s( i+1, j+1 ).update( ba->align_, ii, j, ba->align_->s( ii, j ).score_ + ( a_[i] == b_[j] ? hit_ : -miss_ ) ) ) matched = true;
     }
     else
     {
         // Try skip empty bubble
-        if ( s_[i+1][j+1].update( this, ba->start_, j, s_[ba->start_][j].score_ + ( a_[i] == b_[j] ? hit_ : -miss_ ) ) ) s_[i+1][j+1].deletion_ = matched = true;
+        if ( s( i+1, j+1 ).update( this, ba->start_, j, s( ba->start_, j ).score_ + ( a_[i] == b_[j] ? hit_ : -miss_ ) ) ) s( i+1, j+1 ).deletion_ = matched = true;
     }
     
     // Insert a_, gap b_
-    if ( s_[i+1][j+1].update( ba->iMax_[j].align_, ba->iMax_[j].i_, j+1, ba->iMax_[j].score( gapOpen_, gapExt_ ) ) ) matched = false;
+    if ( s( i+1, j+1 ).update( ba->iMax_[j].align_, ba->iMax_[j].i_, j+1, ba->iMax_[j].score( gapOpen_, gapExt_ ) ) ) matched = false;
     
     // Take iMaxes if superior
     if ( iMax[j].score( gapOpen_, gapExt_ ) < ba->iMax_[j].score( gapOpen_, gapExt_ ) ) iMax[j] = ba->iMax_[j];
@@ -467,7 +624,7 @@ SnpAlignment::AlignPointer SnpAlignment::getEnd( SnpAlignResult& result )
 {
     AlignPointer best;
     int i = freeEnds_[1] ? ijMax_.first : a_.size(), j = freeEnds_[1] ? ijMax_.second : b_.size();
-    best.set( this, i, j, s_[i][j].score_ );
+    best.set( this, i, j, s( i, j ).score_ );
     for ( BubbleAlign* ba : bubbles_ )
     {
         if ( !ba->isDeletion() && ( freeEnds_[1] || ba->end_ == a_.size() ) )
@@ -475,7 +632,7 @@ SnpAlignment::AlignPointer SnpAlignment::getEnd( SnpAlignResult& result )
             AlignPointer alt = ba->align_->getEnd( result );
             if ( best.update( alt.align_, alt.i_, alt.j_, alt.score_ ) ) result.bubbles_.clear();
         }
-        else if ( ba->isDeletion() && ba->end_ == a_.size() && best.update( this, ba->start_, j, s_[ba->start_][j].score_ ) )
+        else if ( ba->isDeletion() && ba->end_ == a_.size() && best.update( this, ba->start_, j, s( ba->start_, j ).score_ ) )
         {
             result.bubbles_.clear();
             SnpAlignResult::BubbleAlignCoords bac;
@@ -517,8 +674,8 @@ SnpAlignResult SnpAlignment::align( bool lAnchored, bool rAnchored )
     SnpAlignment* cur = start.align_;
     int i = start.i_, j = start.j_;
     
-    AlignPointer* ap = &cur->s_[i][j];
-    while ( ap && ap != &s_[0][0] )
+    AlignPointer* ap = &cur->s( i, j );
+    while ( ap && ap != &s( 0, 0 ) )
     {
         assert( ap->align_ );
         bool terminated = ap->align_ == cur && ap->i_ == i && ap->j_ == j;
@@ -554,7 +711,7 @@ SnpAlignResult SnpAlignment::align( bool lAnchored, bool rAnchored )
         for ( int k : { 0, 1 } ) if ( result.s_[k].size() < result.s_[!k].size() ) result.s_[k] += string( result.s_[!k].size()-result.s_[k].size(), '-' );
         
         cur = ap->align_;
-        ap = &cur->s_[ap->i_][ ap->j_];
+        ap = &cur->s( ap->i_, ap->j_ );
     }
     
     finish( result, start );
@@ -725,7 +882,7 @@ vector<pair<SnpAlignment*, int>> SnpAlignment::findEnd()
         vector<pair<SnpAlignment*, int>> bubbleList = ba->align_->findEnd();
         bubbleList.insert( bubbleList.begin(), make_pair( ba->align_, a_.size()-ba->end_ ) );
         SnpAlignment* cur = bubbleList.back().first;
-        if ( cur->s_[cur->ijMax_.first][cur->ijMax_.second].score_ <= best->s_[best->ijMax_.first][best->ijMax_.second].score_ ) continue;
+        if ( cur->s( cur->ijMax_.first, cur->ijMax_.second ).score_ <= best->s( best->ijMax_.first, best->ijMax_.second ).score_ ) continue;
         assert( false );
         best = cur;
         bubbleList = bestList;
@@ -24,24 +24,41 @@
 #include "types.h"
 #include "bubble.h"
 #include "align_result.h"
+#include "scratch_arena.h"
 
 struct SNPs;
 
 class Alignment
 {
+    friend class KernelCheck;
     void score();
+    void scoreBanded();
+    void scoreCheckpointed();
+    void scoreRow( int i, int* prev, int* m, int* p, int* iMax, int* iRef, int* best );
+    void scoreScalar();
+    void scoreStriped();
     void debug();
+    int getGap( int i, int j );
+    int getIndex( int i, int j );
+    int getScore( int i, int j );
     bool isFreeStart( int i, int j );
+    void loadBlock( int i );
+    static const int lanes_;
+    static const uint64_t checkpointCells_;
 //    vector< vector<int> > p_;
 protected:
-    string a_, b_;
-    vector< vector<int> > m_, p_;
-    int hit_, miss_, gapOpen_, gapExt_, iMax_, jMax_;
-    bool freeEnds_[2], scored_;
+    SeqView a_, b_;
+    ScratchBuffer<int> m_, p_, marks_;
+    ScratchBuffer<int16_t> h_;
+    ScratchBuffer<uint8_t> t_;
+    int hit_, miss_, gapOpen_, gapExt_, iMax_, jMax_, stripe_, step_, block_, diag_, band_;
+    bool freeEnds_[2], scored_, striped_;
 public:
+    Alignment( SeqView a, SeqView b );
     Alignment( string& a, string& b, int aStart, int aLen, int bStart, int bLen );
     AlignResult align( int hit, int miss, int gapOpen, int gapExt, bool lAnchored, bool rAnchored );
     AlignResult align( bool lAnchored, bool rAnchored );
+    void setBand( int diag, int band );
     static AlignResult alignBySeed( string& a, string& b, int aStart, int bStart, int len );
 };
 
@@ -118,7 +135,8 @@ class SnpAlignment : Alignment
     void setBubble( vector<BubbleAlign*>& prv, BubbleAlign* ba, vector<GapPointer> iMax, int ii );
     void getBubble( BubbleAlign* ba, vector<GapPointer>& iMax, int i, int j, bool& matched );
     vector<SNPs*> snps_;
-    vector< vector<AlignPointer> > s_;
+    AlignPointer& s( int i, int j ){ return s_[ i*( b_.size()+1 ) + j ]; };
+    ScratchBuffer<AlignPointer> s_;
 //    vector< vector< pair<int, int> > > snp_;
 //    vector< pair<Bubble*, SnpAlignment> > bubble_;
     vector<BubbleAlign*> bubbles_;
@@ -0,0 +1,186 @@
+/*
+ * Copyright (C) 2017 Glen T. Wilkins <glen.t.wilkins@gmail.com>
+ * Written by Glen T. Wilkins
+ * 
+ * This file is part of the consensible software package <https://github.com/gtwilkins/Consensible>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "alignment.h"
+#include <algorithm>
+#include <climits>
+
+// Striped (Farrar) form of Alignment::score using 16-bit lanes. Read position j is held in lane j / segs of segment j % segs.
+// The scalar gap trackers are equivalent to Gotoh gap states fed only by ungapped cells, which lets the row gap be resolved by
+// the usual lazy carry across lanes. Each cell keeps its score and a gap kind (0 ungapped, 1 gap in a, 2 gap in b).
+
+#if defined( __AVX2__ )
+#include <immintrin.h>
+typedef __m256i Vec;
+const int Alignment::lanes_ = 16;
+static inline Vec vSet( int x ){ return _mm256_set1_epi16( x ); }
+static inline Vec vLoad( int16_t* p ){ return _mm256_loadu_si256( (Vec*)p ); }
+static inline void vStore( int16_t* p, Vec a ){ _mm256_storeu_si256( (Vec*)p, a ); }
+static inline Vec vAdd( Vec a, Vec b ){ return _mm256_adds_epi16( a, b ); }
+static inline Vec vSub( Vec a, Vec b ){ return _mm256_subs_epi16( a, b ); }
+static inline Vec vMax( Vec a, Vec b ){ return _mm256_max_epi16( a, b ); }
+static inline Vec vGt( Vec a, Vec b ){ return _mm256_cmpgt_epi16( a, b ); }
+static inline Vec vOr( Vec a, Vec b ){ return _mm256_or_si256( a, b ); }
+static inline Vec vAnd( Vec a, Vec b ){ return _mm256_and_si256( a, b ); }
+static inline Vec vAndNot( Vec a, Vec b ){ return _mm256_andnot_si256( a, b ); }
+static inline bool vAny( Vec a ){ return _mm256_movemask_epi8( a ); }
+static inline Vec vShift( Vec a, int x ){ return _mm256_insert_epi16( _mm256_alignr_epi8( a, _mm256_permute2x128_si256( a, a, 0x08 ), 14 ), x, 0 ); }
+static inline void vPack( uint8_t* p, Vec a, Vec b ){ _mm256_storeu_si256( (Vec*)p, _mm256_permute4x64_epi64( _mm256_packs_epi16( a, b ), 0xD8 ) ); }
+#elif defined( __SSE2__ )
+#include <emmintrin.h>
+typedef __m128i Vec;
+const int Alignment::lanes_ = 8;
+static inline Vec vSet( int x ){ return _mm_set1_epi16( x ); }
+static inline Vec vLoad( int16_t* p ){ return _mm_loadu_si128( (Vec*)p ); }
+static inline void vStore( int16_t* p, Vec a ){ _mm_storeu_si128( (Vec*)p, a ); }
+static inline Vec vAdd( Vec a, Vec b ){ return _mm_adds_epi16( a, b ); }
+static inline Vec vSub( Vec a, Vec b ){ return _mm_subs_epi16( a, b ); }
+static inline Vec vMax( Vec a, Vec b ){ return _mm_max_epi16( a, b ); }
+static inline Vec vGt( Vec a, Vec b ){ return _mm_cmpgt_epi16( a, b ); }
+static inline Vec vOr( Vec a, Vec b ){ return _mm_or_si128( a, b ); }
+static inline Vec vAnd( Vec a, Vec b ){ return _mm_and_si128( a, b ); }
+static inline Vec vAndNot( Vec a, Vec b ){ return _mm_andnot_si128( a, b ); }
+static inline bool vAny( Vec a ){ return _mm_movemask_epi8( a ); }
+static inline Vec vShift( Vec a, int x ){ return _mm_insert_epi16( _mm_slli_si128( a, 2 ), x, 0 ); }
+static inline void vPack( uint8_t* p, Vec a, Vec b ){ _mm_storeu_si128( (Vec*)p, _mm_packs_epi16( a, b ) ); }
+#else
+const int Alignment::lanes_ = 1;
+#endif
+
+#if defined( __AVX2__ ) || defined( __SSE2__ )
+
+static inline Vec vBlend( Vec mask, Vec a, Vec b ){ return vOr( vAnd( mask, a ), vAndNot( mask, b ) ); }
+
+void Alignment::scoreStriped()
+{
+    const int neg = SHRT_MIN / 2, aLen = a_.size(), bLen = b_.size();
+    int segs = ( bLen + lanes_ - 1 ) / lanes_;
+    segs += segs & 1;
+    stripe_ = segs * lanes_;
+    striped_ = true;
+    h_.resize( aLen * stripe_ );
+    t_.resize( aLen * stripe_ );
+    
+    ScratchBuffer<int16_t> work, profile;
+    int chars[256]{0}, n = 0;
+    for ( char c : a_ ) if ( !chars[ (uint8_t)c ] ) chars[ (uint8_t)c ] = ++n;
+    work.assign( stripe_ * 5 + lanes_, 0 );
+    profile.assign( stripe_ * ( n+1 ), neg );
+    int16_t* prv = work.data(),* diag = prv + stripe_,* row = diag + stripe_,* cols = row + stripe_,* kinds = cols + stripe_,* lanes = kinds + stripe_;
+    for ( int j = 0; j < stripe_; j++ ) cols[j] = neg;
+    for ( int j = 0; j < bLen; j++ ) prv[ j % segs * lanes_ + j / segs ] = freeEnds_[0] ? 0 : -gapOpen_ - ( ( j+1 ) * gapExt_ );
+    for ( int c = 0; c < 256; c++ ) if ( chars[c] ) for ( int j = 0; j < bLen; j++ )
+    {
+        profile[ chars[c]*stripe_ + j % segs * lanes_ + j / segs ] = b_[j] == (char)c ? hit_ : -miss_;
+    }
+    
+    Vec zero = vSet( 0 ), all = vGt( vSet( 1 ), zero ), negs = vSet( neg ), ext = vSet( gapExt_ ), open = vSet( gapOpen_ + gapExt_ );
+    Vec first = vShift( zero, -1 );
+    iMax_ = jMax_ = 0;
+    int best = 0;
+    for ( int i = 0; i < aLen; i++ )
+    {
+        int16_t* h = &h_[ i*stripe_ ],* prof = &profile[ chars[ (uint8_t)a_[i] ]*stripe_ ];
+        Vec d = vShift( vLoad( prv + stripe_-lanes_ ), freeEnds_[0] || !i ? 0 : -gapOpen_ - ( i * gapExt_ ) ), e = negs;
+        
+        // First pass carries the row gap within each lane only
+        for ( int s = 0; s < segs; s++ )
+        {
+            Vec dd = vAdd( d, vLoad( prof + s*lanes_ ) ), f = vLoad( cols + s*lanes_ );
+            d = vLoad( prv + s*lanes_ );
+            Vec a = vGt( e, dd ), m = vMax( dd, e ), b = vGt( f, m );
+            m = vMax( m, f );
+            a = vAndNot( b, a );
+            if ( freeEnds_[0] )
+            {
+                Vec clip = vGt( zero, m );
+                m = vMax( m, zero );
+                a = vAndNot( clip, a );
+                b = vAndNot( clip, b );
+            }
+            vStore( diag + s*lanes_, dd );
+            vStore( row + s*lanes_, e );
+            vStore( h + s*lanes_, m );
+            vStore( kinds + s*lanes_, vOr( vAnd( a, vSet( 1 ) ), vAnd( b, vSet( 2 ) ) ) );
+            Vec open0 = s ? vAndNot( vOr( a, b ), all ) : vOr( vAndNot( vOr( a, b ), all ), first );
+            e = vMax( vSub( e, ext ), vBlend( open0, vSub( m, open ), negs ) );
+        }
+        
+        // Lazy pass carries the row gap across lanes until no cell would change
+        e = vShift( e, neg );
+        for ( int s = 0; ; )
+        {
+            Vec old = vLoad( row + s*lanes_ );
+            if ( !vAny( vGt( e, old ) ) ) break;
+            e = vMax( e, old );
+            Vec dd = vLoad( diag + s*lanes_ ), f = vLoad( cols + s*lanes_ );
+            Vec a = vGt( e, dd ), m = vMax( dd, e ), b = vGt( f, m );
+            m = vMax( m, f );
+            a = vAndNot( b, a );
+            if ( freeEnds_[0] )
+            {
+                Vec clip = vGt( zero, m );
+                m = vMax( m, zero );
+                a = vAndNot( clip, a );
+                b = vAndNot( clip, b );
+            }
+            vStore( row + s*lanes_, e );
+            vStore( h + s*lanes_, m );
+            vStore( kinds + s*lanes_, vOr( vAnd( a, vSet( 1 ) ), vAnd( b, vSet( 2 ) ) ) );
+            Vec open0 = s ? vAndNot( vOr( a, b ), all ) : vOr( vAndNot( vOr( a, b ), all ), first );
+            e = vMax( vSub( e, ext ), vBlend( open0, vSub( m, open ), negs ) );
+            if ( ++s == segs ) e = vShift( e, neg );
+            if ( s == segs ) s = 0;
+        }
+        
+        // Column gaps for the next row are fed by ungapped cells, and always by the first row
+        Vec best0 = negs;
+        for ( int s = 0; s < segs; s++ )
+        {
+            Vec m = vLoad( h + s*lanes_ ), ungapped = vGt( vSet( 1 ), vLoad( kinds + s*lanes_ ) );
+            vStore( cols + s*lanes_, vMax( vSub( vLoad( cols + s*lanes_ ), ext ), vBlend( i ? ungapped : all, vSub( m, open ), negs ) ) );
+            best0 = vMax( best0, vBlend( ungapped, m, negs ) );
+            if ( s & 1 ) vPack( &t_[ i*stripe_ + ( s-1 )*lanes_ ], vLoad( kinds + ( s-1 )*lanes_ ), vLoad( kinds + s*lanes_ ) );
+        }
+        vStore( lanes, best0 );
+        int rowBest = *max_element( lanes, lanes + lanes_ );
+        if ( rowBest > best ) for ( int j = 0; j < bLen; j++ )
+        {
+            int k = j % segs * lanes_ + j / segs;
+            if ( kinds[k] || h[k] != rowBest ) continue;
+            best = rowBest;
+            iMax_ = i+1;
+            jMax_ = j+1;
+            break;
+        }
+        copy( h, h + stripe_, prv );
+    }
+    scored_ = true;
+}
+
+#else
+
+void Alignment::scoreStriped()
+{
+    // Without SIMD lanes_ is 1 and score() never comes here, but any other caller still gets a scored matrix
+    scoreScalar();
+}
+
+#endif
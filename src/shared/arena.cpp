@@ -0,0 +1,79 @@
+/*
+ * Copyright (C) 2017 Glen T. Wilkins <glen.t.wilkins@gmail.com>
+ * Written by Glen T. Wilkins
+ * 
+ * This file is part of the consensible software package <https://github.com/gtwilkins/Consensible>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "arena.h"
+#include <cstdlib>
+
+Arena::Arena()
+: block_( NULL ), used_( blockSize_ )
+{}
+
+Arena::~Arena()
+{
+    for ( auto it = objects_.rbegin(); it != objects_.rend(); it++ ) if ( (*it)->destroy_ ) (*it)->destroy_( *it + 1 );
+    for ( char* block : blocks_ ) free( block );
+}
+
+Arena*& Arena::current()
+{
+    static thread_local Arena* arena = NULL;
+    return arena;
+}
+
+void* Arena::allocate( size_t n, void (*destroy)( void* ) )
+{
+    n = ( sizeof( Header ) + n + 15 ) & ~(size_t)15;
+    lock_guard<mutex> lock( lock_ );
+    Header* h;
+    if ( n > blockSize_ / 4 )
+    {
+        blocks_.push_back( (char*)malloc( n ) );
+        h = (Header*)blocks_.back();
+    }
+    else
+    {
+        if ( used_ + n > blockSize_ ) blocks_.push_back( block_ = (char*)malloc( blockSize_ ) );
+        if ( used_ + n > blockSize_ ) used_ = 0;
+        h = (Header*)( block_ + used_ );
+        used_ += n;
+    }
+    h->destroy_ = destroy;
+    h->arena_ = this;
+    objects_.push_back( h );
+    return h + 1;
+}
+
+void* Arena::create( size_t n, void (*destroy)( void* ) )
+{
+    if ( current() ) return current()->allocate( n, destroy );
+    
+    // Without a current arena the object is an ordinary heap allocation
+    Header* h = (Header*)malloc( sizeof( Header ) + n );
+    h->destroy_ = NULL;
+    h->arena_ = NULL;
+    return h + 1;
+}
+
+void Arena::release( void* p )
+{
+    Header* h = (Header*)p - 1;
+    if ( h->arena_ ) h->destroy_ = NULL;
+    else free( h );
+}
@@ -0,0 +1,66 @@
+/*
+ * Copyright (C) 2017 Glen T. Wilkins <glen.t.wilkins@gmail.com>
+ * Written by Glen T. Wilkins
+ * 
+ * This file is part of the consensible software package <https://github.com/gtwilkins/Consensible>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef ARENA_H
+#define ARENA_H
+
+#include "types.h"
+#include <mutex>
+
+// Bump allocator that owns every object created while it is current and destroys them all at once when it is
+class Arena
+{
+    struct Header
+    {
+        void (*destroy_)( void* );
+        Arena* arena_;
+    };
+    char* block_;
+    size_t used_;
+    vector<char*> blocks_;
+    vector<Header*> objects_;
+    mutex lock_;
+    static const size_t blockSize_ = 1 << 16;
+    static Arena*& current();
+public:
+    Arena();
+    ~Arena();
+    void* allocate( size_t n, void (*destroy)( void* ) );
+    static void* create( size_t n, void (*destroy)( void* ) );
+    static void release( void* p );
+    
+    struct Scope
+    {
+        Scope( Arena* arena ): prev_( current() ){ current() = arena; };
+        ~Scope(){ current() = prev_; };
+        Arena* prev_;
+    };
+};
+
+// Allocates T from the current thread's arena, where delete only runs the destructor and the memory is reclaimed with the arena
+template<typename T>
+struct ArenaObject
+{
+    static void* operator new( size_t n ){ return Arena::create( n, []( void* p ){ static_cast<T*>( p )->~T(); } ); };
+    static void operator delete( void* p ){ Arena::release( p ); };
+};
+
+#endif /* ARENA_H */
+
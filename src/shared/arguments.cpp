@@ -25,11 +25,12 @@
 #include <cassert>
 #include <dirent.h>
 #include <unistd.h>
+#include <thread>
 
 using namespace std;
 
 Arguments::Arguments( int argc, char** argv )
-: workDir_( "./consensible_index" ), outFolder_( "./" ), outPrefix_( "./consensible-out" ), pInput_( 0 ), reindex_( false ), cleanup_( false ), help_( false ), finished_( false )
+: workDir_( "./consensible_index" ), outFolder_( "./" ), outPrefix_( "./consensible-out" ), pInput_( 0 ), damage_( 0 ), maxDepth_( 0 ), shards_( 0 ), threads_( max( 1, (int)thread::hardware_concurrency() ) ), maxNodes_( 50000000 ), maxTime_( 0 ), targetCost_( 5000000 ), batchCache_( false ), collapse_( false ), compressIds_( false ), poa_( false ), stream_( false ), reindex_( false ), cleanup_( false ), help_( false ), finished_( false )
 {
     for ( int i ( 1 ); i < argc; i++ )
     {
@@ -58,6 +59,49 @@ Arguments::Arguments( int argc, char** argv )
             if ( i+1 >= argc || argv[i+1][0] == '-') error( "No inputs given with -q flag" );
             while ( i+1 < argc && argv[i+1][0] != '-' ) queries_.push_back( argv[++i] );
         }
+        else if ( !strcmp( argv[i], "--damage" ) )
+        {
+            if ( i+1 >= argc || argv[i+1][0] == '-') error( "No value given with --damage flag" );
+            damage_ = getNumber( argv[++i], "--damage" );
+            if ( damage_ > 63 ) error( "The --damage window may not exceed 63 bases" );
+        }
+        else if ( !strcmp( argv[i], "--threads" ) || !strcmp( argv[i], "-t" ) )
+        {
+            if ( i+1 >= argc || argv[i+1][0] == '-') error( "No value given with --threads flag" );
+            threads_ = getNumber( argv[++i], "--threads" );
+            if ( threads_ < 1 ) error( "At least one thread is required" );
+        }
+        else if ( !strcmp( argv[i], "--max-depth" ) )
+        {
+            if ( i+1 >= argc || argv[i+1][0] == '-') error( "No value given with --max-depth flag" );
+            maxDepth_ = getNumber( argv[++i], "--max-depth" );
+        }
+        else if ( !strcmp( argv[i], "--shards" ) )
+        {
+            if ( i+1 >= argc || argv[i+1][0] == '-') error( "No value given with --shards flag" );
+            shards_ = getNumber( argv[++i], "--shards" );
+            if ( shards_ < 1 ) error( "At least one shard is required" );
+        }
+        else if ( !strcmp( argv[i], "--max-nodes" ) )
+        {
+            if ( i+1 >= argc || argv[i+1][0] == '-') error( "No value given with --max-nodes flag" );
+            maxNodes_ = getNumber( argv[++i], "--max-nodes" );
+        }
+        else if ( !strcmp( argv[i], "--max-time" ) )
+        {
+            if ( i+1 >= argc || argv[i+1][0] == '-') error( "No value given with --max-time flag" );
+            maxTime_ = getNumber( argv[++i], "--max-time" );
+        }
+        else if ( !strcmp( argv[i], "--target-cost" ) )
+        {
+            if ( i+1 >= argc || argv[i+1][0] == '-') error( "No value given with --target-cost flag" );
+            targetCost_ = getNumber( argv[++i], "--target-cost" );
+        }
+        else if ( !strcmp( argv[i], "--batch-cache" ) ) batchCache_ = true;
+        else if ( !strcmp( argv[i], "--collapse" ) ) collapse_ = true;
+        else if ( !strcmp( argv[i], "--compress-ids" ) ) compressIds_ = true;
+        else if ( !strcmp( argv[i], "--poa" ) ) poa_ = true;
+        else if ( !strcmp( argv[i], "--stream" ) ) stream_ = true;
         else if ( !strcmp( argv[i], "--reindex" ) ) reindex_ = true;
         else if ( !strcmp( argv[i], "--cleanup" ) ) cleanup_ = true;
         else if ( !strcmp( argv[i], "-h" ) || !strcmp( argv[i], "--help" ) ) help_ = true;
@@ -251,6 +295,14 @@ void Arguments::updateFileIndex()
     ofs.close();
 }
 
+double Arguments::getNumber( string num, string flag )
+{
+    char* end;
+    double x = strtod( num.c_str(), &end );
+    if ( *end || x < 0 ) error( "Invalid value given with " + flag + " flag: \"" + num + "\"" );
+    return x;
+}
+
 void Arguments::error( string msg )
 {
     cerr << msg << endl;
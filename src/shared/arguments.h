@@ -23,6 +23,7 @@
 
 #include <vector>
 #include <string>
+#include <cstdint>
 
 struct Arguments
 {
@@ -32,8 +33,10 @@ struct Arguments
     std::vector<std::string> inputs_, outputs_, queries_, input_;
     std::string bwtPrefix_, workDir_, outFolder_, outPrefix_;
     std::vector<std::pair<std::string, std::string>> fileIndex_;
-    int pInput_;
-    bool reindex_, cleanup_, help_, finished_;
+    int pInput_, damage_, maxDepth_, shards_, threads_;
+    uint64_t maxNodes_;
+    double maxTime_, targetCost_;
+    bool batchCache_, collapse_, compressIds_, poa_, stream_, reindex_, cleanup_, help_, finished_;
 private:
     void addInput( std::string fn );
     void checkWorkingDir();
@@ -41,6 +44,7 @@ private:
     std::vector<std::string> getFilenameParts( std::string filestr );
     std::vector<std::string> getFilenames( std::string filestr );
     void getFilenames( std::string filestr, std::vector<std::string>& parts, std::vector<std::string>& filenames, int i );
+    double getNumber( std::string num, std::string flag );
     void setOutFolder( std::string folder );
     void setOutputs();
     void error( std::string msg );
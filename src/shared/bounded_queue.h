@@ -0,0 +1,64 @@
+/*
+ * Copyright (C) 2017 Glen T. Wilkins <glen.t.wilkins@gmail.com>
+ * Written by Glen T. Wilkins
+ * 
+ * This file is part of the consensible software package <https://github.com/gtwilkins/Consensible>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef BOUNDED_QUEUE_H
+#define BOUNDED_QUEUE_H
+
+#include "types.h"
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+
+// Blocking FIFO of fixed capacity: a producer waits while it is full, and the consumer waits while it is empty until it is closed
+template<typename T>
+class BoundedQueue
+{
+    deque<T> items_;
+    mutex lock_;
+    condition_variable space_, ready_;
+    int capacity_;
+    bool closed_;
+public:
+    BoundedQueue( int capacity ): capacity_( capacity ), closed_( false ){};
+    void close()
+    {
+        lock_guard<mutex> lock( lock_ );
+        closed_ = true;
+        ready_.notify_all();
+    };
+    bool pop( vector<T>& items, int limit )
+    {
+        unique_lock<mutex> lock( lock_ );
+        ready_.wait( lock, [&](){ return closed_ || !items_.empty(); } );
+        items.clear();
+        for ( ; !items_.empty() && items.size() < limit; items_.pop_front() ) items.push_back( move( items_.front() ) );
+        space_.notify_all();
+        return !items.empty();
+    };
+    void push( T item )
+    {
+        unique_lock<mutex> lock( lock_ );
+        space_.wait( lock, [&](){ return items_.size() < capacity_; } );
+        items_.push_back( move( item ) );
+        ready_.notify_one();
+    };
+};
+
+#endif /* BOUNDED_QUEUE_H */
@@ -0,0 +1,77 @@
+/*
+ * Copyright (C) 2017 Glen T. Wilkins <glen.t.wilkins@gmail.com>
+ * Written by Glen T. Wilkins
+ * 
+ * This file is part of the consensible software package <https://github.com/gtwilkins/Consensible>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "edit_distance.h"
+
+atomic<uint64_t> EditDistance::tested_( 0 );
+atomic<uint64_t> EditDistance::filtered_( 0 );
+atomic<uint64_t> EditDistance::skipped_( 0 );
+
+EditDistance::EditDistance( const char* p, int m )
+: blocks_( ( m + 63 ) / 64 ), m_( m )
+{
+    int chars = 0;
+    for ( int i = 0; i < 256; i++ ) index_[i] = -1;
+    for ( int i = 0; i < m; i++ ) if ( index_[ (uint8_t)p[i] ] < 0 ) index_[ (uint8_t)p[i] ] = chars++;
+    peq_.assign( chars * blocks_.size(), 0 );
+    for ( int i = 0; i < m; i++ ) peq_[ index_[ (uint8_t)p[i] ]*blocks_.size() + i / 64 ] |= 1ULL << ( i % 64 );
+}
+
+int EditDistance::semiGlobal( const char* t, int n, int limit )
+{
+    // Myers' bit-vector algorithm with Hyyrö's multi-word carry; returns the least distance of the whole pattern to any substring of t, or stops early once limit is reached
+    int last = blocks_.size()-1, best = m_;
+    uint64_t lastBit = 1ULL << ( ( m_-1 ) % 64 );
+    for ( int b = 0; b <= last; b++ ) blocks_[b] = Block{ ~0ULL, 0, min( ( b+1 ) * 64, m_ ) };
+    for ( int j = 0; j < n && best > limit; j++ )
+    {
+        int c = index_[ (uint8_t)t[j] ], hin = 0;
+        for ( int b = 0; b <= last; b++ )
+        {
+            Block& k = blocks_[b];
+            uint64_t eq = c < 0 ? 0 : peq_[ c*blocks_.size() + b ], hNeg = hin < 0;
+            uint64_t xv = eq | k.mv_;
+            eq |= hNeg;
+            uint64_t xh = ( ( ( eq & k.pv_ ) + k.pv_ ) ^ k.pv_ ) | eq;
+            uint64_t ph = k.mv_ | ~( xh | k.pv_ ), mh = k.pv_ & xh;
+            uint64_t bit = b == last ? lastBit : 1ULL << 63;
+            int hout = ( ph & bit ? 1 : 0 ) - ( mh & bit ? 1 : 0 );
+            ph = ( ph << 1 ) | ( hin > 0 );
+            mh = ( mh << 1 ) | hNeg;
+            k.pv_ = mh | ~( xv | ph );
+            k.mv_ = ph & xv;
+            k.score_ += hout;
+            hin = hout;
+        }
+        best = min( best, blocks_[last].score_ );
+    }
+    return best;
+}
+
+bool EditDistance::isWithin( string& t, int tStart, int tLen, string& p, int limit )
+{
+    // Called from pool workers in stream mode; the counts are only read once the pool is idle, so no ordering is needed
+    tested_.fetch_add( 1, memory_order_relaxed );
+    tLen = min( tLen, (int)t.size()-tStart );
+    if ( EditDistance( p.c_str(), p.size() ).semiGlobal( t.c_str()+tStart, tLen, limit ) <= limit ) return true;
+    filtered_.fetch_add( 1, memory_order_relaxed );
+    skipped_.fetch_add( (uint64_t)tLen * p.size(), memory_order_relaxed );
+    return false;
+}
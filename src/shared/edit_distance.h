@@ -0,0 +1,45 @@
+/*
+ * Copyright (C) 2017 Glen T. Wilkins <glen.t.wilkins@gmail.com>
+ * Written by Glen T. Wilkins
+ * 
+ * This file is part of the consensible software package <https://github.com/gtwilkins/Consensible>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef EDIT_DISTANCE_H
+#define EDIT_DISTANCE_H
+
+#include "types.h"
+#include <atomic>
+
+class EditDistance
+{
+    struct Block
+    {
+        uint64_t pv_, mv_;
+        int score_;
+    };
+    vector<uint64_t> peq_;
+    vector<Block> blocks_;
+    int index_[256], m_;
+public:
+    EditDistance( const char* p, int m );
+    int semiGlobal( const char* t, int n, int limit );
+    static bool isWithin( string& t, int tStart, int tLen, string& p, int limit );
+    static atomic<uint64_t> tested_, filtered_, skipped_;
+};
+
+#endif /* EDIT_DISTANCE_H */
+
@@ -26,7 +26,7 @@
 #include <thread>
 
 Filenames::Filenames( string inPrefix )
-: prefix( inPrefix )
+: prefix( inPrefix + ( ID_SIZE > 4 ? "-wide" : "" ) )
 {
     string folder = inPrefix.substr( 0, inPrefix.find_last_of( '/' ) );
     makeFolder( folder );
@@ -34,8 +34,11 @@ Filenames::Filenames( string inPrefix )
     bin = prefix + "-bin.dat";
     bwt = prefix + "-bwt.dat";
     ids = prefix + "-ids.dat";
+    idc = prefix + "-idc.dat";
     idx = prefix + "-idx.dat";
     mer = prefix + "-mer.dat";
+    mul = prefix + "-mul.dat";
+    shards = prefix + "-shards.txt";
 }
 
 bool Filenames::exists( string &filename )
@@ -142,6 +145,19 @@ void Filenames::makeFolder( string folder )
     }
 }
 
+string Filenames::getShard( string inPrefix, int shard )
+{
+    return inPrefix + "-shard" + to_string( shard + 1 );
+}
+
+int Filenames::getShards()
+{
+    int count = 0;
+    ifstream ifs( shards );
+    if ( ifs ) ifs >> count;
+    return count;
+}
+
 void Filenames::removeFile( string &filename )
 {
     if ( remove( filename.c_str() ) )
@@ -150,6 +166,12 @@ void Filenames::removeFile( string &filename )
     }
 }
 
+void Filenames::setShards( int count )
+{
+    if ( count > 1 && count != getShards() ) ofstream( shards ) << count << endl;
+    if ( count < 2 && exists( shards ) ) removeFile( shards );
+}
+
 void Filenames::setIndex( FILE* &inBin, FILE* &inBwt, FILE* &inIdx, FILE* &inMer )
 {
     inBin = getReadPointer( bin, false );
@@ -215,7 +237,7 @@ void PreprocessFiles::getState( bool& isComplete, bool& canResume, bool& isIndex
     if ( !fp ) return;
     
     uint8_t readLen = 0, cycle = 0;
-    uint32_t seqCount = 0;
+    ReadId seqCount = 0;
     uint64_t binId = 0, bwtId = 0, idsId = 0, idxId = 0;
     
     fseek( fp, 1, SEEK_SET );
@@ -223,7 +245,7 @@ void PreprocessFiles::getState( bool& isComplete, bool& canResume, bool& isIndex
     fread( &readLen, 1, 1, fp );
     fread( &cycle, 1, 1, fp );
     fseek( fp, 16, SEEK_SET );
-    fread( &seqCount, 4, 1, fp );
+    fread( &seqCount, ID_SIZE, 1, fp );
     fclose( fp );
     
     if ( !readLen || !seqCount ) return;
@@ -239,7 +261,7 @@ void PreprocessFiles::getState( bool& isComplete, bool& canResume, bool& isIndex
     fclose( fp );
     if ( bwtId != binId ) return;
     
-    if ( !( fp = getReadPointer( ids, false, true ) ) ) return;
+    if ( !( fp = getReadPointer( ids, false, true ) ) && !( fp = getReadPointer( idc, false, true ) ) ) return;
     fseek( fp, 1, SEEK_SET );
     fread( &idsId, 8, 1, fp );
     fclose( fp );
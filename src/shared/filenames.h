@@ -30,6 +30,7 @@ struct Filenames
     Filenames( string inPrefix );
     
     static bool exists( string &filename );
+    static string getShard( string inPrefix, int shard );
     
     FILE* getReadPointer( string &filename, bool doEdit, bool allowFail=false );
     FILE* getWritePointer( string &filename );
@@ -37,17 +38,22 @@ struct Filenames
     ofstream getWriteStream( string &filename );
     
     FILE* getBinary( bool doRead, bool doEdit );
+    int getShards();
     static bool isFolder( string folder );
     static void makeFolder( string folder );
     void removeFile( string &filename );
     void setIndex( FILE* &inBin, FILE* &inBwt, FILE* &inIdx, FILE* &inMer );
+    void setShards( int count );
     
     string prefix;
     string bin;
     string bwt;
     string ids;
+    string idc;
     string idx;
     string mer;
+    string mul;
+    string shards;
 };
 
 struct PreprocessFiles : public Filenames
@@ -0,0 +1,84 @@
+/*
+ * Copyright (C) 2017 Glen T. Wilkins <glen.t.wilkins@gmail.com>
+ * Written by Glen T. Wilkins
+ * 
+ * This file is part of the consensible software package <https://github.com/gtwilkins/Consensible>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SCRATCH_ARENA_H
+#define SCRATCH_ARENA_H
+
+#include "types.h"
+#include <algorithm>
+#include <climits>
+
+// Read-only window onto a caller's string, used in place of substring copies; the string must outlive the view
+struct SeqView
+{
+    SeqView(): s_( "" ), len_( 0 ){};
+    SeqView( const string& s, int start=0, int len=INT_MAX ): s_( s.c_str()+start ), len_( max( 0, min( len, (int)s.size()-start ) ) ){};
+    char operator[]( int i ) const { return s_[i]; }
+    bool empty() const { return !len_; }
+    int size() const { return len_; }
+    const char* begin() const { return s_; }
+    const char* end() const { return s_+len_; }
+    string substr( int start, int len=INT_MAX ) const { return string( s_+start, min( len, len_-start ) ); }
+    const char* s_;
+    int len_;
+};
+
+// Per-thread pool of flat buffers; a ScratchBuffer borrows one for its lifetime and returns it with its capacity intact
+template<typename T>
+class ScratchBuffer
+{
+    struct Pool
+    {
+        ~Pool(){ for ( vector<T>* v : free_ ) delete v; }
+        vector< vector<T>* > free_;
+    };
+    static Pool& pool()
+    {
+        static thread_local Pool p;
+        return p;
+    }
+    static vector<T>* acquire()
+    {
+        Pool& p = pool();
+        if ( p.free_.empty() ) return new vector<T>();
+        vector<T>* v = p.free_.back();
+        p.free_.pop_back();
+        return v;
+    }
+    vector<T>* buf_;
+public:
+    ScratchBuffer(): buf_( acquire() ){};
+    ScratchBuffer( const ScratchBuffer& rhs ): buf_( acquire() ){ *buf_ = *rhs.buf_; };
+    ScratchBuffer& operator=( const ScratchBuffer& rhs ){ *buf_ = *rhs.buf_; return *this; };
+    ~ScratchBuffer()
+    {
+        // Very large buffers are not worth pinning for the life of the thread
+        if ( buf_->capacity() * sizeof( T ) > ( 1 << 28 ) ) delete buf_;
+        else pool().free_.push_back( buf_ );
+    }
+    T& operator[]( size_t i ){ return (*buf_)[i]; }
+    void assign( size_t n, const T& x ){ buf_->assign( n, x ); }
+    void resize( size_t n ){ buf_->resize( n ); }
+    size_t size(){ return buf_->size(); }
+    T* data(){ return buf_->data(); }
+};
+
+#endif /* SCRATCH_ARENA_H */
+
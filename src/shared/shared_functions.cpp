@@ -24,7 +24,7 @@
 #include <cassert>
 #include <string.h>
 
-vector<uint16_t> get8mers( string seq, int i, int end )
+vector<uint16_t> get8mers( const string& seq, int i, int end )
 {
     uint16_t kmer = ( charToInt[seq[i]] << 14 ) + ( charToInt[seq[i+1]] << 12 ) + ( charToInt[seq[i+2]] << 10 ) + ( charToInt[seq[i+3]] << 8 )
              + ( charToInt[seq[i+4]] << 6 ) + ( charToInt[seq[i+5]] << 4 ) + ( charToInt[seq[i+6]] << 2 ) + ( charToInt[seq[i+7]] );
@@ -132,6 +132,34 @@ vector<CharId> getKmers( string& seq, int len )
     return kmers;
 }
 
+vector<int> getMismatches( string& t, int tStart, string& q, int limit )
+{
+    vector<int> misses;
+    const char* a = t.c_str() + tStart, * b = q.c_str();
+    uint64_t x, y;
+    for ( int i = 0; i < q.size() && misses.size() <= limit; i += 8 )
+    {
+        if ( i+8 > q.size() ) for ( ; i < q.size(); i++ ) if ( a[i] != b[i] ) misses.push_back( i );
+        if ( i >= q.size() ) break;
+        memcpy( &x, a+i, 8 );
+        memcpy( &y, b+i, 8 );
+        if ( x != y ) for ( int j = i; j < i+8; j++ ) if ( a[j] != b[j] ) misses.push_back( j );
+    }
+    return misses;
+}
+
+vector<int> getReservoirSample( int n, int limit, mt19937& rng )
+{
+    // Uniform sample of at most limit of the indices 0 to n-1 in one pass
+    vector<int> chosen;
+    for ( int k = 0, slot; k < n; k++ )
+    {
+        if ( chosen.size() < limit ) chosen.push_back( k );
+        else if ( ( slot = rng() % ( k+1 ) ) < limit ) chosen[slot] = k;
+    }
+    return chosen;
+}
+
 bool getSeq( ifstream& ifs, string& header, string& seq )
 {
     string line;
@@ -23,14 +23,17 @@
 
 #include "types.h"
 #include <fstream>
+#include <random>
 
-vector<uint16_t> get8mers( string seq, int i, int end );
+vector<uint16_t> get8mers( const string& seq, int i, int end );
 char getComp( char c );
 int getEndTrim( string &q, string trim, bool drxn );
 int getHomopolymerLen( string &s, bool drxn );
 int getHomopolymerScore( string &s );
 uint64_t getKmer( string& seq, int i, int len );
 vector<CharId> getKmers( string& seq, int len );
+vector<int> getMismatches( string& t, int tStart, string& q, int limit );
+vector<int> getReservoirSample( int n, int limit, mt19937& rng );
 bool getSeq( ifstream& ifs, string& header, string& seq );
 bool isSequence( string &s );
 bool mapSeq( string &q, string &t, int* coords, int minLen );
@@ -20,7 +20,6 @@
 
 #include "shared_structs.h"
 #include "shared_functions.h"
-#include "local_alignment.h"
 #include "parameters.h"
 #include <algorithm>
 #include <cassert>
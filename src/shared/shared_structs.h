@@ -48,12 +48,13 @@ struct Mapped
 
 struct Read
 {
-    Read( string seq, ReadId id, int i, int j ): seq_( seq ), id_( id ), coords_( Coords( i, j ) ){};
+    Read( string seq, ReadId id, int i, int j ): seq_( seq ), id_( id ), coords_( Coords( i, j ) ), count_( 1 ){};
     static unordered_set<ReadId> getIds( vector<Read>& reads, int coord, bool coordDrxn, bool readDrxn );
     static void sort( vector<Read>& reads, bool ascending, bool coordDrxn );
     string seq_;
     ReadId id_;
     Coords coords_;
+    uint32_t count_;
 };
 
 
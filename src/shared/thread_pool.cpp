@@ -0,0 +1,91 @@
+/*
+ * Copyright (C) 2017 Glen T. Wilkins <glen.t.wilkins@gmail.com>
+ * Written by Glen T. Wilkins
+ * 
+ * This file is part of the consensible software package <https://github.com/gtwilkins/Consensible>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "thread_pool.h"
+
+ThreadPool::ThreadPool( int threads )
+: queues_( max( 1, threads ) ), round_( 0 ), busy_( 0 ), stop_( false )
+{
+    for ( int t = 1; t < queues_.size(); t++ ) workers_.push_back( thread( [this, t](){ work( t ); } ) );
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        lock_guard<mutex> lock( lock_ );
+        stop_ = true;
+    }
+    start_.notify_all();
+    for ( thread& w : workers_ ) w.join();
+}
+
+bool ThreadPool::take( int t, int& task )
+{
+    for ( int i = 0; i < queues_.size(); i++ )
+    {
+        Queue& q = queues_[ ( t+i ) % queues_.size() ];
+        lock_guard<mutex> lock( q.lock_ );
+        if ( q.tasks_.empty() ) continue;
+        if ( i ) task = q.tasks_.back();
+        else task = q.tasks_.front();
+        if ( i ) q.tasks_.pop_back();
+        else q.tasks_.pop_front();
+        return true;
+    }
+    return false;
+}
+
+void ThreadPool::work( int t )
+{
+    for ( uint64_t round = 0;; )
+    {
+        {
+            unique_lock<mutex> lock( lock_ );
+            start_.wait( lock, [&](){ return stop_ || round_ != round; } );
+            if ( stop_ ) return;
+            round = round_;
+        }
+        for ( int i; take( t, i ); ) task_( i );
+        lock_guard<mutex> lock( lock_ );
+        if ( !--busy_ ) done_.notify_one();
+    }
+}
+
+void ThreadPool::run( int n, function<void( int )> task )
+{
+    // Tasks never spawn more tasks, so a thread is finished once every queue is empty; run is not reentrant
+    int threads = min( n, (int)queues_.size() );
+    for ( int i = 0; i < n; i++ ) queues_[ i % threads ].tasks_.push_back( i );
+    if ( threads < 2 )
+    {
+        for ( int i; threads && take( 0, i ); ) task( i );
+        return;
+    }
+    {
+        lock_guard<mutex> lock( lock_ );
+        task_ = task;
+        busy_ = workers_.size();
+        round_++;
+    }
+    start_.notify_all();
+    for ( int i; take( 0, i ); ) task( i );
+    unique_lock<mutex> lock( lock_ );
+    done_.wait( lock, [&](){ return !busy_; } );
+}
@@ -0,0 +1,56 @@
+/*
+ * Copyright (C) 2017 Glen T. Wilkins <glen.t.wilkins@gmail.com>
+ * Written by Glen T. Wilkins
+ * 
+ * This file is part of the consensible software package <https://github.com/gtwilkins/Consensible>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include "types.h"
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+// Persistent workers sleep between batches; each batch of tasks is dealt out across per-thread queues, and idle threads steal from the back of the others
+class ThreadPool
+{
+    struct Queue
+    {
+        deque<int> tasks_;
+        mutex lock_;
+    };
+    bool take( int t, int& task );
+    void work( int t );
+    vector<Queue> queues_;
+    vector<thread> workers_;
+    function<void( int )> task_;
+    mutex lock_;
+    condition_variable start_, done_;
+    uint64_t round_;
+    int busy_;
+    bool stop_;
+public:
+    ThreadPool( int threads );
+    ~ThreadPool();
+    void run( int n, function<void( int )> task );
+};
+
+#endif /* THREAD_POOL_H */
+
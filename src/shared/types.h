@@ -32,8 +32,14 @@ using namespace std;
 
 #define LEANBWT_VERSION "1.0"
 
+// Read ends are numbered in 32 bits unless built with "make WIDE=1", which doubles id storage to index past 2^32 read ends
+#ifdef WIDE_IDS
+typedef uint64_t ReadId;
+#else
 typedef uint32_t ReadId;
-typedef uint32_t SeqNum;
+#endif
+#define ID_SIZE sizeof( ReadId )
+typedef ReadId SeqNum;
 typedef uint64_t CharId;
 typedef uint8_t Char;
 
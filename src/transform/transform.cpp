@@ -19,6 +19,7 @@
  */
 
 #include "transform.h"
+#include "shared_functions.h"
 #include <iostream>
 #include <fstream>
 #include <sys/stat.h>
@@ -28,7 +29,7 @@
 //#include <chrono>
 //#include <iomanip>
 
-void Transform::load( PreprocessFiles* fns, vector<string>& infilenames, bool revComp )
+void Transform::load( vector<PreprocessFiles*>& fns, vector<string>& infilenames, bool revComp, bool collapse )
 {
     assert( infilenames.size() == 1 );
     int minScore = 0;
@@ -40,10 +41,15 @@ void Transform::load( PreprocessFiles* fns, vector<string>& infilenames, bool re
 //    cout << "    Read length set to " << to_string( readLen ) << "." << endl;
 //    cout << "    Min length set to " << to_string( minLen ) << "." << endl;
     
-    ReadId readCount = 0, discardCount = 0;
+    ReadId readCount = 0, discardCount = 0, dupeCount = 0, uniqueCount = 0;
     double readStartTime = clock();
     
-    BinaryWriter* binWrite = new BinaryWriter( fns, 0, readLen, revComp );
+    // Duplicates, in either orientation when both are indexed, are stored once and counted
+    int shards = fns.size();
+    vector< unordered_map<string, ReadId> > unique( shards );
+    vector< vector<uint32_t> > counts( shards );
+    vector<BinaryWriter*> binWrite( shards, NULL );
+    for ( int i = 0; i < shards; i++ ) if ( fns[i] ) binWrite[i] = new BinaryWriter( fns[i], 0, readLen, revComp );
     
     for ( ReadFile* rf : infiles )
     {
@@ -52,9 +58,27 @@ void Transform::load( PreprocessFiles* fns, vector<string>& infilenames, bool re
         string read;
         while ( rf->getNext( read ) )
         {
-            if ( read.length() >= minLen ) binWrite->write( read );
-            else discardCount++;
             thisReadCount++;
+            if ( read.length() < minLen )
+            {
+                discardCount++;
+                continue;
+            }
+            
+            // Shards split reads by a hash of their orientation-independent sequence, so duplicates always share a shard; shards already built are passed as NULL
+            string key = shards > 1 || collapse ? ( revComp ? min( read, revCompNew( read ) ) : read ) : "";
+            int s = shards > 1 ? hash<string>()( key ) % shards : 0;
+            if ( !binWrite[s] ) continue;
+            if ( collapse )
+            {
+                auto ins = unique[s].insert( make_pair( key, counts[s].size() ) );
+                if ( !ins.second ) counts[s][ ins.first->second ]++;
+                if ( !ins.second ) dupeCount++;
+                if ( !ins.second ) continue;
+                counts[s].push_back( 1 );
+                uniqueCount++;
+            }
+            binWrite[s]->write( read );
         }
         delete rf;
         readCount += thisReadCount;
@@ -63,17 +87,31 @@ void Transform::load( PreprocessFiles* fns, vector<string>& infilenames, bool re
         cout << "    Found " << to_string( thisReadCount-discardCount ) << " useable reads in file, discarded " << to_string( discardCount ) << " short reads." << endl;
     }
     
+    if ( collapse ) cout << "    Collapsed " << to_string( dupeCount ) << " duplicate reads into " << to_string( uniqueCount ) << " unique sequences." << endl;
     cout << endl;
     
-    binWrite->close();
-    delete binWrite;
+    for ( int i = 0; i < shards; i++ )
+    {
+        if ( !binWrite[i] ) continue;
+        binWrite[i]->close();
+        
+        // Multiplicities are keyed to this binary by its id so that a stale file is never read against a rebuilt index
+        if ( collapse )
+        {
+            FILE* mul = fns[i]->getWritePointer( fns[i]->mul );
+            fwrite( &binWrite[i]->id, 8, 1, mul );
+            fwrite( counts[i].data(), 4, counts[i].size(), mul );
+            fclose( mul );
+        }
+        else if ( Filenames::exists( fns[i]->mul ) ) fns[i]->removeFile( fns[i]->mul );
+        if ( Filenames::exists( fns[i]->idc ) ) fns[i]->removeFile( fns[i]->idc );
+        delete binWrite[i];
+    }
 }
 
-void Transform::run( PreprocessFiles* fns )
+void Transform::run( PreprocessFiles* fns, bool verbose )
 {
-    bool verbose = true;
     if ( verbose ) cout << "Preprocessing sequence data... " << endl;
-    else cout << "Preprocessing sequence data... " << flush;
     
     BinaryReader* bin = new BinaryReader( fns );
     BwtCycler* cycler = new BwtCycler( fns );
@@ -105,7 +143,61 @@ void Transform::run( PreprocessFiles* fns )
     delete cycler;
     
     if ( verbose ) cout << "Proprecessing complete! Time taken: " << getDuration( totalStart ) << endl << endl;
-    else cout << "Complete! Time taken: " << getDuration( totalStart ) << endl << endl;
 //    cout << "   " << std::fixed << std::setprecision(2) << ( clock() - totalStart ) / CLOCKS_PER_SEC << " vs " << ( ( std::chrono::high_resolution_clock::now() - t_start ).count() / 1000.0 ) / CLOCKS_PER_SEC << endl << endl;
 //    cout << endl;
 }
+
+void Transform::compressIds( PreprocessFiles* fns )
+{
+    // Ids are packed in fixed blocks as offsets from the block minimum, so any rank range decodes from its own blocks alone
+    FILE* ids = fns->getReadPointer( fns->ids, false );
+    uint8_t idsBegin, idcBegin = 21;
+    uint32_t blockLen = 128;
+    uint64_t id;
+    fread( &idsBegin, 1, 1, ids );
+    fread( &id, 8, 1, ids );
+    fseek( ids, 0, SEEK_END );
+    CharId idsSize = ftell( ids ), count = ( idsSize - idsBegin ) / ID_SIZE;
+    fseek( ids, idsBegin, SEEK_SET );
+    
+    vector<uint64_t> offsets( ( count + blockLen - 1 ) / blockLen + 1 );
+    vector<ReadId> block( blockLen );
+    vector<uint8_t> packed( blockLen * ID_SIZE + 8 );
+    FILE* idc = fns->getWritePointer( fns->idc );
+    fwrite( &idcBegin, 1, 1, idc );
+    fwrite( &id, 8, 1, idc );
+    fwrite( &count, 8, 1, idc );
+    fwrite( &blockLen, 4, 1, idc );
+    offsets[0] = idcBegin + offsets.size() * 8;
+    fseek( idc, offsets[0], SEEK_SET );
+    
+    for ( size_t i = 0; i+1 < offsets.size(); i++ )
+    {
+        size_t n = fread( block.data(), ID_SIZE, blockLen, ids );
+        ReadId base = *min_element( block.begin(), block.begin() + n ), range = *max_element( block.begin(), block.begin() + n ) - base;
+        uint8_t width = 0;
+        while ( width < 8 * ID_SIZE && range >> width ) width++;
+        assert( width <= 56 );
+        fill( packed.begin(), packed.end(), 0 );
+        for ( size_t j = 0; j < n; j++ )
+        {
+            uint64_t bits;
+            memcpy( &bits, &packed[ j * width / 8 ], 8 );
+            bits |= uint64_t( block[j] - base ) << ( j * width % 8 );
+            memcpy( &packed[ j * width / 8 ], &bits, 8 );
+        }
+        size_t len = ( n * width + 7 ) / 8;
+        fwrite( &base, ID_SIZE, 1, idc );
+        fwrite( &width, 1, 1, idc );
+        fwrite( packed.data(), 1, len, idc );
+        offsets[i+1] = offsets[i] + ID_SIZE + 1 + len;
+    }
+    
+    fseek( idc, idcBegin, SEEK_SET );
+    fwrite( offsets.data(), 8, offsets.size(), idc );
+    fclose( idc );
+    fclose( ids );
+    fns->removeFile( fns->ids );
+    
+    cout << "Compressed read ids from " << to_string( idsSize ) << " to " << to_string( offsets.back() ) << " bytes." << endl << endl;
+}
@@ -30,8 +30,9 @@
 class Transform 
 {
 public:
-    static void load( PreprocessFiles* fns, vector<string>& infilenames, bool revComp );
-    static void run( PreprocessFiles* fns );
+    static void load( vector<PreprocessFiles*>& fns, vector<string>& infilenames, bool revComp, bool collapse );
+    static void run( PreprocessFiles* fns, bool verbose=true );
+    static void compressIds( PreprocessFiles* fns );
     
 };
 
@@ -37,7 +37,7 @@ BinaryReader::BinaryReader( PreprocessFiles* filenames )
     fread( &cycle, 1, 1, bin );
     fread( &revComp, 1, 1, bin );
     fseek( bin, 16, SEEK_SET );
-    fread( &seqCount, 4, 1, bin );
+    fread( &seqCount, ID_SIZE, 1, bin );
     
     lineLen = 1 + ( readLen + 3 ) / 4;
     fileSize = (CharId)seqCount * (CharId)lineLen;
@@ -71,7 +71,7 @@ BinaryReader::BinaryReader( PreprocessFiles* filenames )
     trm = fns->getReadPointer( fns->tmpTrm, false );
     
     CharId trimSkip = trmBegin;
-    if ( cycle >= minTrim ) for ( int i = 0; i < ( cycle+1-minTrim ); i++ ) trimSkip += trimCounts[i]*4;
+    if ( cycle >= minTrim ) for ( int i = 0; i < ( cycle+1-minTrim ); i++ ) trimSkip += trimCounts[i]*ID_SIZE;
     assert( !trimCounts.empty() || minTrim == readLen );
     if ( !trimCounts.empty() ) fseek( trm, trimSkip, SEEK_SET );
     if ( cycle > 2 ) fseek( chr, ( cycle-2 ) * charSize, SEEK_SET );
@@ -100,7 +100,7 @@ void BinaryReader::init()
     for ( int i( 0 ); i < 4; i++ ) for ( int j( 0 ); j < 4; j++ )
     {
         ids[i][j] = fns->getReadPointer( fns->tmpIds[0][i][j], true );
-        fseek( ids[i][j], 4, SEEK_SET );
+        fseek( ids[i][j], ID_SIZE, SEEK_SET );
     }
     
     uint8_t line[lineLen];
@@ -126,13 +126,13 @@ void BinaryReader::init()
         CharId fpTrims[readLen-minTrim];
         for ( uint8_t j = 0; j+minTrim < readLen; j++ )
         {
-            fpTrims[j] = j ? fpTrims[j-1] + ( trimCounts[j-1] * 4 ) : trmBegin;
+            fpTrims[j] = j ? fpTrims[j-1] + ( trimCounts[j-1] * ID_SIZE ) : trmBegin;
             bufTrim[j] = new ReadId[1000];
             totalTrims += trimCounts[j];
         }
         
         trm = fns->getReadPointer( fns->tmpTrm, true );
-        fseek( trm, CharId( totalTrims ) * 4 - 1 + trmBegin, SEEK_SET );
+        fseek( trm, CharId( totalTrims ) * ID_SIZE - 1 + trmBegin, SEEK_SET );
         fwrite( line, 1, 1, trm );
 
         for ( ReadId id = 0; id < seqCount; id++ )
@@ -163,8 +163,8 @@ void BinaryReader::init()
                 if ( pTrim[j] == 1000 )
                 {
                     fseek( trm, fpTrims[j], SEEK_SET );
-                    fwrite( bufTrim[j], 4, pTrim[j], trm );
-                    fpTrims[j] += pTrim[j]*4;
+                    fwrite( bufTrim[j], ID_SIZE, pTrim[j], trm );
+                    fpTrims[j] += pTrim[j]*ID_SIZE;
                     pTrim[j] = 0;
                 }
                 
@@ -184,7 +184,7 @@ void BinaryReader::init()
             i++;
             
             idsCounts[ seq[base] ][ seq[base-1] ]++;
-            fwrite( &id, 4, 1, ids[ seq[base] ][ seq[base-1] ] );
+            fwrite( &id, ID_SIZE, 1, ids[ seq[base] ][ seq[base-1] ] );
 
             if ( !revComp ) continue;
             
@@ -192,7 +192,7 @@ void BinaryReader::init()
             for ( uint8_t j = 3; j < line[0]; j++ ) outs[j][p] |= intToByte[i][ 3-seq[j] ];
             chars[pChar] |= intToByte[i++][ 3-seq[2] ];
             idsCounts[ 3-seq[0] ][ 3-seq[1] ]++;
-            fwrite( &id, 4, 1, ids[ 3-seq[0] ][ 3-seq[1] ] );
+            fwrite( &id, ID_SIZE, 1, ids[ 3-seq[0] ][ 3-seq[1] ] );
         }
         
         if ( i ? ++p : p ) for ( uint8_t j = 3; j < readLen; j++ )
@@ -205,8 +205,8 @@ void BinaryReader::init()
         for ( uint8_t j = 0; j+minTrim < readLen; j++ ) if ( pTrim[j] )
         {
             fseek( trm, fpTrims[j], SEEK_SET );
-            fwrite( bufTrim[j], 4, pTrim[j], trm );
-            fpTrims[j] += pTrim[j]*4;
+            fwrite( bufTrim[j], ID_SIZE, pTrim[j], trm );
+            fpTrims[j] += pTrim[j]*ID_SIZE;
         }
         
         for ( uint8_t j = 0; j < readLen; j++ ) delete outs[j];
@@ -219,7 +219,7 @@ void BinaryReader::init()
     for ( int i = 0; i < 4; i++ ) for ( int j = 0; j < 4; j++ )
     {
         fseek( ids[i][j], 0, SEEK_SET );
-        fwrite( &idsCounts[i][j], 4, 1, ids[i][j] );
+        fwrite( &idsCounts[i][j], ID_SIZE, 1, ids[i][j] );
         fclose( ids[i][j] );
     }
     
@@ -266,12 +266,12 @@ void BinaryReader::init()
     fwrite( &writeEndBwt, 1, 1, bwt );
     fwrite( &bwtCount, 8, 1, bwt );
     fwrite( &charCounts, 8, 5, bwt );
-    fwrite( &basePos, 4, 4, bwt );
+    fwrite( &basePos, ID_SIZE, 4, bwt );
     fclose( bwt );
     
     FILE* ends = fns->getWritePointer( fns->tmpEnd[0] );
     ReadId endcount = 0;
-    fwrite( &endcount, 4, 1, ends );
+    fwrite( &endcount, ID_SIZE, 1, ends );
     fclose( ends );
     
 //    cout << std::fixed << std::setprecision(2) << " read: " << ( clock() - readStart ) / CLOCKS_PER_SEC << " vs " << ( ( std::chrono::high_resolution_clock::now() - t_start ).count() / 1000.0 ) / CLOCKS_PER_SEC << endl;
@@ -285,7 +285,7 @@ void BinaryReader::prep()
     ReadId inTrim;
     for ( uint8_t j = 0; j+minTrim < readLen; j++ )
     {
-        fread( &inTrim, 4, 1, trm );
+        fread( &inTrim, ID_SIZE, 1, trm );
         trimCounts.push_back( inTrim );
     }
     fclose( trm );
@@ -316,7 +316,7 @@ void BinaryReader::read()
         ReadId id;
         for ( ReadId j = 0; j < trimCounts[i]; j++ )
         {
-            fread( &id, 4, 1, trm );
+            fread( &id, ID_SIZE, 1, trm );
             ends[id/8] |= endBitArray[id % 8];
             endCount++;
         }
@@ -355,13 +355,14 @@ BinaryWriter::BinaryWriter( PreprocessFiles* filenames, uint8_t inLibCount, uint
     binBuff = new uint8_t[buffSize];
     
     if ( libCount ) libCounts = new ReadId[libCount]{0};
-    seqsBegin = 21 + ( libCount * 12 );
+    seqsBegin = 17 + ID_SIZE + ( libCount * ( ID_SIZE + 8 ) );
     
     for ( int i = 0; i < 4; i++ ) for ( int j = 0; j < 4; j++ ) charPlaceCounts[i][j].resize( readLen, 0 );
     
     uint8_t dummy8 = 0, revCal = revComp ? 2 : 0;
     uint16_t dummy16 = 0;
     uint32_t dummy32 = 0;
+    ReadId dummyId = 0;
     
     fwrite( &seqsBegin, 1, 1, bin );             // Byte offset of first sequence
     fwrite( &id, 8, 1, bin );                    // ID number for this transform session
@@ -369,11 +370,11 @@ BinaryWriter::BinaryWriter( PreprocessFiles* filenames, uint8_t inLibCount, uint
     fwrite( &cycle, 1, 1, bin );                 // Current cycles complete
     fwrite( &revCal, 1, 1, bin );                // Is calibrated
     fwrite( &dummy32, 4, 1, bin );               // Estimated coverage
-    fwrite( &seqCount, 4, 1, bin );              // Sequence count for each library, total sequence count
+    fwrite( &seqCount, ID_SIZE, 1, bin );        // Sequence count for each library, total sequence count
     fwrite( &libCount, 1, 1, bin );              // Number of libraries
     for ( int i ( 0 ); i < libCount; i++ )
     {
-        fwrite( &dummy32, 4, 1, bin );           // Library sequence count
+        fwrite( &dummyId, ID_SIZE, 1, bin );     // Library sequence count
         fwrite( &dummy16, 2, 3, bin );           // Library insert size estimates
         fwrite( &dummy8, 1, 2, bin );            // Library type details
     }
@@ -413,11 +414,11 @@ void BinaryWriter::close()
     assert( dummy );
     
     fseek( bin, 16, SEEK_SET );
-    fwrite( &seqCount, 4, 1, bin );
-    fseek( bin, 21, SEEK_SET );
+    fwrite( &seqCount, ID_SIZE, 1, bin );
+    fseek( bin, 17 + ID_SIZE, SEEK_SET );
     for ( int i ( 0 ); i < libCount; i++ )
     {
-        fwrite( &libCounts[i], 4, 1, bin );
+        fwrite( &libCounts[i], ID_SIZE, 1, bin );
         fseek( bin, 8, SEEK_CUR );
     }
     fclose( bin );
@@ -427,10 +428,10 @@ void BinaryWriter::close()
     uint8_t minReadLen = readLen;
     for ( uint8_t i = 0; i < readLen; i++ ) if ( readLens[i] ) minReadLen = min( minReadLen, i );
     assert( minReadLen );
-    uint16_t trimBegin = 3 + ( ( readLen-minReadLen ) * 4 );
+    uint16_t trimBegin = 3 + ( ( readLen-minReadLen ) * ID_SIZE );
     fwrite( &trimBegin, 2, 1, trm );
     fwrite( &minReadLen, 1, 1, trm );
-    for ( uint8_t i = minReadLen; i < readLen; i++ ) fwrite( &readLens[i], 4, 1, trm );
+    for ( uint8_t i = minReadLen; i < readLen; i++ ) fwrite( &readLens[i], ID_SIZE, 1, trm );
     fclose( trm );
      
     // Set ids bucket limits
@@ -444,8 +445,8 @@ void BinaryWriter::close()
             for ( int k : { 0, 1 } )
             {
                 FILE* fp = fns->getWritePointer( fns->tmpIds[k][i][j] );
-                fseek( fp, limit*4, SEEK_SET );
-                fwrite( &limit, 4, 1, fp );
+                fseek( fp, limit*ID_SIZE, SEEK_SET );
+                fwrite( &limit, ID_SIZE, 1, fp );
                 fclose( fp );
             }
         }
@@ -453,7 +454,7 @@ void BinaryWriter::close()
         {
             ReadId dummy = 0;
             FILE* fp = fns->getWritePointer( fns->tmpIds[k][i][4] );
-            fwrite( &dummy, 4, 1, fp );
+            fwrite( &dummy, ID_SIZE, 1, fp );
             fclose( fp );
         }
     }
@@ -547,14 +548,14 @@ void BinaryWriter::writeBwt()
     fwrite( &writeEndBwt, 1, 1, bwt );
     fwrite( &bwtCount, 8, 1, bwt );
     fwrite( &charCounts, 8, 5, bwt );
-    fwrite( &basePos, 4, 4, bwt );
+    fwrite( &basePos, ID_SIZE, 4, bwt );
     fclose( bwt );
 }
 
 void BinaryWriter::writeEnd()
 {
     ReadId endcount = 0;
-    fwrite( &endcount, 4, 1, ends );
+    fwrite( &endcount, ID_SIZE, 1, ends );
     fclose( ends );
 }
 
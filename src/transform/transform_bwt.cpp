@@ -194,7 +194,7 @@ void BwtCycler::finish( uint8_t cycle )
     fclose( inBwt );
     fwrite( outBwtBuff, 1, pOutBwt, outBwt );
     fclose( outBwt );
-    fwrite( outEndBuff, 4, pOutEnd, outEnd );
+    fwrite( outEndBuff, ID_SIZE, pOutEnd, outEnd );
     fclose( outEnd );
     outBwt = fns->getReadPointer( fns->bwt, true );
     uint8_t bwtBegin = 57;
@@ -324,7 +324,7 @@ void BwtCycler::flush( uint8_t cycle )
     writeLast();
     fwrite( outBwtBuff, 1, pOutBwt, outBwt );
     fclose( outBwt );
-    fwrite( outEndBuff, 4, pOutEnd, outEnd );
+    fwrite( outEndBuff, ID_SIZE, pOutEnd, outEnd );
     fclose( outEnd );
     
     for ( int i ( 0 ); i < 4; i++ )
@@ -340,7 +340,7 @@ void BwtCycler::flush( uint8_t cycle )
     fwrite( &bwtCount, 8, 1, outBwt );
     fwrite( &charCounts, 8, 4, outBwt );
     fclose( outBwt );
-    fwrite ( &endCount, 4, 1, outEnd );
+    fwrite ( &endCount, ID_SIZE, 1, outEnd );
     fclose( outEnd );
     
     for ( int i ( 0 ); i < 4; i++ )
@@ -364,8 +364,8 @@ void BwtCycler::prepIn()
     fread( &doReadBwtEnds, 1, 1, inBwt );
     fread( &bwtLeft, 8, 1, inBwt );
     fread( &charSizes, 8, 5, inBwt );
-    fread( &basePos, 4, 4, inBwt );
-    fread( &endLeft, 4, 1, inEnd );
+    fread( &basePos, ID_SIZE, 4, inBwt );
+    fread( &endLeft, ID_SIZE, 1, inEnd );
     if ( doReadBwtEnds )
     {
         if ( !readEndBwt ) setReadEnds();
@@ -386,8 +386,8 @@ void BwtCycler::prepIn()
     }
     charCounts[4] = 0;
     memset( lastIns, 0, 32 );
-    memset( inSapCount, 0, 20 );
-    memset( outSapCount, 0, 20 );
+    memset( inSapCount, 0, sizeof( inSapCount ) );
+    memset( outSapCount, 0, sizeof( outSapCount ) );
 }
 
 //void BwtCycler::prepIter()
@@ -478,8 +478,8 @@ void BwtCycler::prepOut()
     fwrite( &writeEndBwt, 1, 1, outBwt );
     fwrite( &bwtCount, 8, 1, outBwt );
     fwrite( &charCounts, 8, 5, outBwt );
-    fwrite( &basePos, 4, 4, outBwt );
-    fwrite( &endCount, 4, 1, outEnd );
+    fwrite( &basePos, ID_SIZE, 4, outBwt );
+    fwrite( &endCount, ID_SIZE, 1, outEnd );
 }
 
 void BwtCycler::prepOutFinal()
@@ -649,12 +649,12 @@ void BwtCycler::rewriteEnd( ReadId runLen )
     {
         if ( pInEnd == IDS_BUFFER )
         {
-            fread( inEndBuff, 4, min( endLeft, IDS_BUFFER ), inEnd );
+            fread( inEndBuff, ID_SIZE, min( endLeft, IDS_BUFFER ), inEnd );
             pInEnd = 0;
         }
         if ( pOutEnd == IDS_BUFFER )
         {
-            fwrite( outEndBuff, 4, IDS_BUFFER, outEnd );
+            fwrite( outEndBuff, ID_SIZE, IDS_BUFFER, outEnd );
             pOutEnd = 0;
         }
         outEndBuff[ pOutEnd++ ] = inEndBuff[ pInEnd++ ];
@@ -875,7 +875,7 @@ void BwtCycler::writeEnd()
     {
         if ( pOutEnd == IDS_BUFFER )
         {
-            fwrite( outEndBuff, 4, IDS_BUFFER, outEnd );
+            fwrite( outEndBuff, ID_SIZE, IDS_BUFFER, outEnd );
             pOutEnd = 0;
         }
         
@@ -1001,7 +1001,7 @@ void BwtCycler::writeNextId()
     {
         if ( pOutEnd == IDS_BUFFER )
         {
-            fwrite( outEndBuff, 4, IDS_BUFFER, outEnd );
+            fwrite( outEndBuff, ID_SIZE, IDS_BUFFER, outEnd );
             pOutEnd = 0;
         }
         
@@ -1066,7 +1066,7 @@ void BwtCycler::writeSame()
         if ( thisSap > 1 )
         {
             // Write IDs and count same runs
-            memset( &outSapCount, 0, 20 );
+            memset( &outSapCount, 0, sizeof( outSapCount ) );
             for ( ReadId j = 0; j < thisSap; j++ )
             {
                 readNextId();
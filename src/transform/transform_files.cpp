@@ -80,7 +80,7 @@ void TransFileLarge::flush()
     if ( p_ ) write();
     fp_ = fopen( fn_.c_str(), "rb+" );
     checkFile( "rb+" );
-    fwrite( &totalSize_, 4, 1, fp_ );
+    fwrite( &totalSize_, ID_SIZE, 1, fp_ );
     fclose( fp_ );
 }
 
@@ -91,7 +91,7 @@ void TransFileLarge::set( std::string fn, bool reader )
     pos_ = 0;
     read_ = reader;
     open_ = false;
-    if ( !buff_ ) buff_ = new uint32_t[buffSize_];
+    if ( !buff_ ) buff_ = new ReadId[buffSize_];
     
 }
 
@@ -99,17 +99,17 @@ void TransFileLarge::read()
 {
     fp_ = fopen( fn_.c_str(), "rb" );
     checkFile( "rb" );
-    if ( !open_ && ( open_ = true ) ) fread( &totalSize_, 4, 1, fp_ );
+    if ( !open_ && ( open_ = true ) ) fread( &totalSize_, ID_SIZE, 1, fp_ );
     else fseek( fp_, pos_, SEEK_SET );
-    curSize_ = min( totalSize_, buffSize_ );
+    curSize_ = min( totalSize_, (ReadId)buffSize_ );
     totalSize_ -= curSize_;
-    fread( buff_, 4, curSize_, fp_ );
+    fread( buff_, ID_SIZE, curSize_, fp_ );
     pos_ = ftell( fp_ );
     fclose( fp_ );
     p_ = 0;
 }
 
-uint32_t TransFileLarge::readNext()
+ReadId TransFileLarge::readNext()
 {
     if ( p_ == curSize_ ) read();
     return buff_[p_++];
@@ -119,16 +119,16 @@ void TransFileLarge::write()
 {
     fp_ = fopen( fn_.c_str(), "rb+" );
     checkFile( "rb+" );
-    if ( !open_ && ( open_ = true ) ) fwrite( &totalSize_, 4, 1, fp_ );
-    else fseek( fp_, ( totalSize_*4 ) + 4, SEEK_SET );
+    if ( !open_ && ( open_ = true ) ) fwrite( &totalSize_, ID_SIZE, 1, fp_ );
+    else fseek( fp_, ( totalSize_*ID_SIZE ) + ID_SIZE, SEEK_SET );
     
     totalSize_ += p_;
-    fwrite( buff_, 4, p_, fp_ );
+    fwrite( buff_, ID_SIZE, p_, fp_ );
     fclose( fp_ );
     p_ = 0;
 }
 
-void TransFileLarge::writeNext( uint32_t b )
+void TransFileLarge::writeNext( ReadId b )
 {
     if ( p_ == buffSize_ ) write();
     buff_[p_++] = b;
@@ -36,7 +36,8 @@ struct TransformFile
     std::string fn_;
     FILE* fp_;
     uint64_t pos_;
-    uint32_t p_, buffSize_, totalSize_, curSize_;
+    uint32_t p_, buffSize_;
+    ReadId totalSize_, curSize_;
     size_t bytes_;
     bool read_, open_;
 };
@@ -51,15 +52,15 @@ struct TransformFile
 
 struct TransFileLarge : TransformFile
 {
-    TransFileLarge():TransformFile(), buff_( NULL ){ buffSize_ = 64*1024; bytes_ = 4; };
+    TransFileLarge():TransformFile(), buff_( NULL ){ buffSize_ = 64*1024; bytes_ = ID_SIZE; };
     ~TransFileLarge();
     void flush();
     void set( string fn, bool reader );
     void read();
     void write();
-    uint32_t readNext();
-    void writeNext( uint32_t b );
-    uint32_t* buff_;
+    ReadId readNext();
+    void writeNext( ReadId b );
+    ReadId* buff_;
 };
 
 #endif /* TRANSFORM_FILES_H */
@@ -80,7 +80,7 @@ inline void writeIdsBuff( FILE* &fIds, ReadId* idsBuff, CharId &p )
 
 inline void writePosBuff( FILE* &fIds, FILE* &fPos, ReadId* idsBuff, CharId* posBuff, CharId &p )
 {
-    fwrite( idsBuff, 4, p, fIds );
+    fwrite( idsBuff, ID_SIZE, p, fIds );
     fwrite( posBuff, 8, p, fPos );
     p = 0;
 }
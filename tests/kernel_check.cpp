@@ -0,0 +1,213 @@
+/*
+ * Copyright (C) 2017 Glen T. Wilkins <glen.t.wilkins@gmail.com>
+ * Written by Glen T. Wilkins
+ * 
+ * This file is part of the consensible software package <https://github.com/gtwilkins/Consensible>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Randomised cross-checks of the fast kernels against their reference forms: the striped, checkpointed and banded
+// alignment kernels against the scalar recurrence, and the bit-vector edit distance against a plain dynamic program.
+// Also checks that the reservoir sample behind --max-depth keeps to its cap and favours no read.
+// Run with "make check".
+
+#include "alignment.h"
+#include "edit_distance.h"
+#include "shared_functions.h"
+#include <iostream>
+#include <random>
+
+class KernelCheck
+{
+    static bool run( Alignment& al, int kernel, int scores[4], bool lAnchored, bool rAnchored, AlignResult& result );
+    static int editDistance( string& t, string& p );
+    static string mutate( string& s, int errors, mt19937& rng );
+    static string random( int len, mt19937& rng );
+    static bool same( AlignResult& x, AlignResult& y );
+public:
+    static bool alignments( int count, mt19937& rng );
+    static bool bands( int count, mt19937& rng );
+    static bool editDistances( int count, mt19937& rng );
+    static bool samples( int count, mt19937& rng );
+};
+
+bool KernelCheck::run( Alignment& al, int kernel, int scores[4], bool lAnchored, bool rAnchored, AlignResult& result )
+{
+    // Forces one kernel where Alignment::score would choose by size; align then only traces back, unless the kernel left the
+    // matrix unscored, which is reported rather than letting align quietly rescore it
+    al.hit_ = scores[0];
+    al.miss_ = scores[1];
+    al.gapOpen_ = scores[2];
+    al.gapExt_ = scores[3];
+    al.freeEnds_[0] = !lAnchored;
+    al.freeEnds_[1] = !rAnchored;
+    al.step_ = 0;
+    al.block_ = -1;
+    if ( kernel == 0 ) al.scoreScalar();
+    if ( kernel == 1 ) al.scoreStriped();
+    if ( kernel == 2 ) al.scoreCheckpointed();
+    if ( kernel == 3 ) al.scoreBanded();
+    if ( !al.scored_ ) return false;
+    result = al.align( lAnchored, rAnchored );
+    return true;
+}
+
+int KernelCheck::editDistance( string& t, string& p )
+{
+    // Least distance of all of p to any substring of t
+    vector<int> prev( t.size()+1, 0 ), cur( t.size()+1 );
+    for ( int i = 0; i < p.size(); i++ )
+    {
+        cur[0] = i+1;
+        for ( int j = 0; j < t.size(); j++ ) cur[j+1] = min( prev[j] + ( p[i] != t[j] ), min( prev[j+1], cur[j] ) + 1 );
+        swap( prev, cur );
+    }
+    return *min_element( prev.begin(), prev.end() );
+}
+
+string KernelCheck::mutate( string& s, int errors, mt19937& rng )
+{
+    string m;
+    for ( char c : s )
+    {
+        int r = rng() % 100;
+        if ( r < errors / 3 ) continue;
+        if ( r < 2 * errors / 3 ) m += "ACGT"[ rng() % 4 ];
+        m += r < errors ? "ACGTN"[ rng() % 5 ] : c;
+    }
+    return m;
+}
+
+string KernelCheck::random( int len, mt19937& rng )
+{
+    string s;
+    for ( int i = 0; i < len; i++ ) s += "ACGT"[ rng() % 4 ];
+    return s;
+}
+
+bool KernelCheck::same( AlignResult& x, AlignResult& y )
+{
+    if ( x.s_[0] != y.s_[0] || x.s_[1] != y.s_[1] || x.score_ != y.score_ || x.start_ != y.start_ || x.len_ != y.len_ ) return false;
+    for ( int d : { 0, 1 } ) if ( x.lIgnore[d] != y.lIgnore[d] || x.rIgnore[d] != y.rIgnore[d] ) return false;
+    return true;
+}
+
+bool KernelCheck::alignments( int count, mt19937& rng )
+{
+    int scoring[2][4]{ { 1, 4, 4, 4 }, { 1, 1, 2, 1 } };
+    const char* names[4]{ "scalar", "striped", "checkpointed", "banded" };
+    for ( int t = 0; t < count; t++ )
+    {
+        string a = random( 1 + rng() % 300, rng ), b = a.substr( rng() % a.size() );
+        b = mutate( b, rng() % 20, rng );
+        if ( b.empty() ) b = "A";
+        int* scores = scoring[ t % 2 ];
+        bool anchors[2]{ bool( rng() % 4 == 0 ), bool( rng() % 4 == 0 ) };
+        
+        // Banding only applies with free ends, and is exact once the band spans the whole matrix
+        for ( int kernel = 1; kernel < 4; kernel++ )
+        {
+            if ( kernel == 3 && ( anchors[0] || anchors[1] ) ) continue;
+            Alignment ref( a, b, 0, a.size(), 0, b.size() ), fast( a, b, 0, a.size(), 0, b.size() );
+            if ( kernel == 3 ) fast.setBand( 0, a.size() + b.size() );
+            AlignResult x, y;
+            bool match = run( ref, 0, scores, anchors[0], anchors[1], x ) && run( fast, kernel, scores, anchors[0], anchors[1], y ) && same( x, y );
+            for ( int i = 0; match && i <= a.size(); i++ ) for ( int j = 0; match && j <= b.size(); j++ ) match = ref.getScore( i, j ) == fast.getScore( i, j );
+            if ( match ) continue;
+            cout << "The " << names[kernel] << " alignment kernel disagrees with the scalar kernel for:" << endl << a << endl << b << endl;
+            cout << x.s_[0] << endl << x.s_[1] << endl << "versus" << endl << y.s_[0] << endl << y.s_[1] << endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+bool KernelCheck::bands( int count, mt19937& rng )
+{
+    // Reads placed as Target::align places them, in a window reaching a read length either side of a known diagonal and banded
+    // narrowly around it. With few enough indels to stay in band the result must match the scalar kernel, and no cell in band may
+    // score above it, as the band only removes paths; cells near its edges may score below it where the best path leaves the band.
+    // Every third read is unmutated and centred a full band to one side, so its only perfect path runs along the band's edge
+    int scoring[2][4]{ { 1, 4, 4, 4 }, { 1, 1, 2, 1 } };
+    for ( int t = 0; t < count; t++ )
+    {
+        int readLen = 30 + rng() % 120, band = 8 + rng() % 9;
+        string tmp = random( readLen + rng() % 400, rng );
+        int coord = rng() % ( tmp.size() - readLen + 1 ), start = max( 0, coord-readLen ), diag = coord-start;
+        string a = tmp.substr( start, diag + 2*readLen ), b = tmp.substr( coord, readLen );
+        if ( t % 3 ) b = mutate( b, rng() % 12, rng );
+        else diag += rng() % 2 ? band : -band;
+        if ( b.empty() ) b = "A";
+        int* scores = scoring[ t % 2 ];
+        Alignment ref( a, b, 0, a.size(), 0, b.size() ), banded( a, b, 0, a.size(), 0, b.size() );
+        banded.setBand( diag, band );
+        AlignResult x, y;
+        bool match = run( ref, 0, scores, false, false, x ) && run( banded, 3, scores, false, false, y ) && same( x, y );
+        for ( int i = 0; match && i <= a.size(); i++ ) for ( int j = 0; match && j <= b.size(); j++ ) match = abs( i-j-diag ) > band || banded.getScore( i, j ) <= ref.getScore( i, j );
+        if ( match ) continue;
+        cout << "The banded alignment kernel (diagonal " << diag << ", band " << band << ") disagrees with the scalar kernel for:" << endl << a << endl << b << endl;
+        cout << x.s_[0] << endl << x.s_[1] << endl << "versus" << endl << y.s_[0] << endl << y.s_[1] << endl;
+        return false;
+    }
+    return true;
+}
+
+bool KernelCheck::editDistances( int count, mt19937& rng )
+{
+    for ( int k = 0; k < count; k++ )
+    {
+        string p = random( 1 + rng() % 200, rng ), t = random( rng() % 100, rng ) + mutate( p, rng() % 30, rng ) + random( rng() % 100, rng );
+        int dist = editDistance( t, p ), limit = rng() % ( p.size() / 4 + 2 );
+        if ( EditDistance( p.c_str(), p.size() ).semiGlobal( t.c_str(), t.size(), -1 ) == dist && EditDistance::isWithin( t, 0, t.size(), p, limit ) == ( dist <= limit ) ) continue;
+        cout << "The bit-vector edit distance disagrees with the dynamic program (" << dist << ") for:" << endl << t << endl << p << endl;
+        return false;
+    }
+    return true;
+}
+
+bool KernelCheck::samples( int count, mt19937& rng )
+{
+    for ( int k = 0; k < count; k++ )
+    {
+        int n = 1 + rng() % 1000, limit = 1 + rng() % 100;
+        vector<int> chosen = getReservoirSample( n, limit, rng );
+        sort( chosen.begin(), chosen.end() );
+        if ( chosen.size() == min( n, limit ) && unique( chosen.begin(), chosen.end() ) == chosen.end() && chosen[0] >= 0 && chosen.back() < n ) continue;
+        cout << "The reservoir sample of " << limit << " from " << n << " kept " << chosen.size() << " reads." << endl;
+        return false;
+    }
+    
+    // Every index should be kept at the same rate, limit/n, across repeated samples
+    int n = 1000, limit = 50, rounds = 4000;
+    vector<int> kept( n, 0 );
+    for ( int k = 0; k < rounds; k++ ) for ( int i : getReservoirSample( n, limit, rng ) ) kept[i]++;
+    for ( int lo : { 0, n/2 } )
+    {
+        int sum = 0;
+        for ( int i = lo; i < lo + n/2; i++ ) sum += kept[i];
+        if ( abs( sum - rounds * limit / 2 ) < rounds * limit / 50 ) continue;
+        cout << "The reservoir sample favours one half of its input: " << sum << " of " << rounds * limit << " picks." << endl;
+        return false;
+    }
+    return true;
+}
+
+int main( int argc, char** argv )
+{
+    mt19937 rng( argc > 1 ? atoi( argv[1] ) : 1 );
+    if ( !KernelCheck::alignments( 1000, rng ) || !KernelCheck::bands( 1000, rng ) || !KernelCheck::editDistances( 3000, rng ) || !KernelCheck::samples( 1000, rng ) ) return 1;
+    cout << "Kernel checks passed." << endl;
+    return 0;
+}